@@ -0,0 +1,126 @@
+#ifndef ALIAS
+#define ALIAS
+
+#include "random.h"
+
+// Walker/Vose alias table: picks index i with probability weight[i] / total in O(1),
+// one bounded random column plus one 16 bit coin flip against that column's threshold.
+// Thresholds are 16 bit fixed point, so chance() gives the exact odds the table produces.
+class AliasTable{
+  public:
+    byte pick(Random& inRandom) const {
+      byte column = inRandom.nextBelow(count);
+      if( alias[column] == column || (uint16_t)(inRandom.next() >> 16) < threshold[column] ){
+        return column;
+      }
+      return alias[column];
+    }
+
+    // Probability of pick() returning inIndex, scaled so 65536 is certain
+    uint32_t chance(byte inIndex) const {
+      uint32_t total = 0;
+      for( byte column = 0; column < count; column++ ){
+        bool bFull = alias[column] == column;
+        if( column == inIndex ){
+          total += bFull ? 65536UL : threshold[column];
+        }
+        else if( !bFull && alias[column] == inIndex ){
+          total += 65536UL - threshold[column];
+        }
+      }
+      return total / count;
+    }
+
+    byte getCount() const {
+      return count;
+    }
+
+  protected:
+    AliasTable(uint16_t* inThreshold, byte* inAlias, byte inCount) : threshold(inThreshold), alias(inAlias), count(inCount) {}
+
+    // The scratch arrays hold count entries each and are only needed while building
+    void build(const uint16_t* inWeights, uint32_t* scaled, byte* small, byte* large){
+      uint32_t totalWeight = 0;
+      for( byte i = 0; i < count; i++ ){
+        totalWeight += inWeights[i];
+      }
+
+      // Scale so the average column holds exactly 65536
+      byte numSmall = 0;
+      byte numLarge = 0;
+      for( byte i = 0; i < count; i++ ){
+        scaled[i] = totalWeight == 0 ? 65536UL : scaleWeight((uint32_t)inWeights[i] * count, totalWeight);
+        if( scaled[i] < 65536UL ){
+          small[numSmall++] = i;
+        }
+        else{
+          large[numLarge++] = i;
+        }
+      }
+
+      // Top up each small column from a large one
+      while( numSmall > 0 && numLarge > 0 ){
+        byte lo = small[--numSmall];
+        byte hi = large[numLarge - 1];
+        threshold[lo] = scaled[lo];
+        alias[lo] = hi;
+        scaled[hi] -= 65536UL - scaled[lo];
+        if( scaled[hi] < 65536UL ){
+          numLarge--;
+          small[numSmall++] = hi;
+        }
+      }
+
+      // Whatever is left is full up to rounding
+      while( numLarge > 0 ){
+        byte i = large[--numLarge];
+        threshold[i] = 0xFFFF;
+        alias[i] = i;
+      }
+      while( numSmall > 0 ){
+        byte i = small[--numSmall];
+        threshold[i] = 0xFFFF;
+        alias[i] = i;
+      }
+    }
+
+  private:
+    // inValue / inTotal in 16 bit fixed point, rounded down. Both are below 2^24 (16 bit
+    // weights times a byte count), so taking the fraction a byte at a time stays in 32 bit
+    // math instead of pulling in 64 bit division for a one-off build.
+    static uint32_t scaleWeight(uint32_t inValue, uint32_t inTotal){
+      uint32_t result = inValue / inTotal;
+      uint32_t remainder = inValue % inTotal;
+      for( byte i = 0; i < 2; i++ ){
+        remainder <<= 8;
+        result = (result << 8) | (remainder / inTotal);
+        remainder %= inTotal;
+      }
+      return result;
+    }
+
+    uint16_t* threshold; // Keep the column when the coin is below this, storage owned by FixedAliasTable
+    byte* alias;         // Otherwise take this index, a column aliased to itself is always kept
+    byte count;
+};
+
+// AliasTable over COUNT weights, built once from inWeights
+template <byte COUNT>
+class FixedAliasTable : public AliasTable{
+  public:
+    static_assert(COUNT > 0, "FixedAliasTable: pick() needs at least one weight");
+    static const byte CAPACITY = COUNT;
+
+    FixedAliasTable(const uint16_t* inWeights) : AliasTable(thresholds, aliases, COUNT) {
+      uint32_t scaled[COUNT];
+      byte small[COUNT];
+      byte large[COUNT];
+      build(inWeights, scaled, small, large);
+    }
+
+  private:
+    uint16_t thresholds[COUNT];
+    byte aliases[COUNT];
+};
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef ASSETS
+#define ASSETS
+
+#include "canvas.h"
+
+// Asset packs are one flash blob built offline by tools/packassets.py:
+//   header   'A', 'P', version, sprite count
+//   entries  per sprite: width, height, frames, flags, data offset from the pack start (uint16 LE)
+//   data     frames back to back, each width * ceil(height / 8) bytes in drawBitmap's page order
+// Sprites are looked up by index, the packer also writes an enum of their names.
+//
+// Compressed sprites (ASSET_FLAG_COMPRESSED) start with a table of uint16 frame offsets from
+// the pack start. Each frame is a stream of ops producing the same page ordered bytes:
+//   0nnnnnnn  n + 1 literal bytes follow
+//   10nnnnnn  the next byte repeated n + 2 times
+//   11nnnnnn  n + 1 bytes copied from the same spot in frame 0 of the base sprite
+// The base is the raw sprite in the low 7 flag bits minus one, 0 meaning there is none.
+const byte ASSET_PACK_VERSION = 2;
+const byte ASSET_HEADER_SIZE = 4;
+const byte ASSET_ENTRY_SIZE = 6;
+const byte ASSET_FLAG_COMPRESSED = 0x80;
+const byte ASSET_BASE_MASK = 0x7F;
+
+struct SpriteInfo {
+  byte width;
+  byte height;
+  byte frames;
+  byte flags;
+  const byte* data; // First frame
+};
+
+class AssetPack{
+  public:
+    const byte* pack; // In PROGMEM
+
+    AssetPack(const byte* inPack) : pack(inPack) {}
+
+    bool isValid() const {
+      return pgm_read_byte(&pack[0]) == 'A' && pgm_read_byte(&pack[1]) == 'P' && pgm_read_byte(&pack[2]) == ASSET_PACK_VERSION;
+    }
+
+    byte getNumSprites() const {
+      return pgm_read_byte(&pack[3]);
+    }
+
+    SpriteInfo getSprite(byte inSprite) const {
+      const byte* entry = pack + ASSET_HEADER_SIZE + inSprite * ASSET_ENTRY_SIZE;
+      SpriteInfo info;
+      info.width = pgm_read_byte(&entry[0]);
+      info.height = pgm_read_byte(&entry[1]);
+      info.frames = pgm_read_byte(&entry[2]);
+      info.flags = pgm_read_byte(&entry[3]);
+      info.data = pack + (pgm_read_byte(&entry[4]) | (pgm_read_byte(&entry[5]) << 8));
+      return info;
+    }
+
+    // Raw frame data, nullptr for compressed sprites
+    const byte* getFrame(byte inSprite, byte inFrame) const {
+      SpriteInfo info = getSprite(inSprite);
+      if( info.flags & ASSET_FLAG_COMPRESSED ){
+        return nullptr;
+      }
+      return info.data + inFrame * frameSize(info);
+    }
+
+    void draw(const RenderTarget& target, int inX, int inY, byte inSprite, byte inFrame) const {
+      SpriteInfo info = getSprite(inSprite);
+      if( info.flags & ASSET_FLAG_COMPRESSED ){
+        drawCompressed(target, inX, inY, info, inFrame);
+        return;
+      }
+      drawBitmap(target, inX, inY, info.data + inFrame * frameSize(info), info.width, info.height);
+    }
+
+    // Decode a compressed frame straight into the target, ORing like drawBitmap with WHITE.
+    // Each decoded byte is plotted as it comes out, so there is no frame sized buffer.
+    void drawCompressed(const RenderTarget& target, int inX, int inY, const SpriteInfo& inInfo, byte inFrame) const {
+      if( inX + inInfo.width < 0 || inX >= WIDTH || inY + inInfo.height < 0 || inY >= HEIGHT ){
+        return;
+      }
+      const byte* frameEntry = inInfo.data + inFrame * 2;
+      const byte* src = pack + (pgm_read_byte(&frameEntry[0]) | (pgm_read_byte(&frameEntry[1]) << 8));
+      const byte* base = nullptr;
+      byte baseIndex = inInfo.flags & ASSET_BASE_MASK;
+      if( baseIndex != 0 ){
+        base = getSprite(baseIndex - 1).data;
+      }
+
+      RENDER_STAT_CALL();
+      BitmapCursor cursor(target, inX, inY, inInfo.width);
+      uint16_t total = frameSize(inInfo);
+      uint16_t pos = 0;
+      while( pos < total ){
+        byte op = pgm_read_byte(src++);
+        if( op < 0x80 ){
+          for( byte n = op + 1; n > 0; n--, pos++ ){
+            cursor.plot(pgm_read_byte(src++));
+          }
+        }
+        else if( op < 0xC0 ){
+          byte value = pgm_read_byte(src++);
+          for( byte n = (op & 0x3F) + 2; n > 0; n--, pos++ ){
+            cursor.plot(value);
+          }
+        }
+        else{
+          for( byte n = (op & 0x3F) + 1; n > 0; n--, pos++ ){
+            cursor.plot(pgm_read_byte(&base[pos]));
+          }
+        }
+      }
+    }
+
+    static uint16_t frameSize(const SpriteInfo& inInfo){
+      return inInfo.width * ((inInfo.height + 7) >> 3);
+    }
+};
+
+#endif
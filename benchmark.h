@@ -0,0 +1,430 @@
+#ifndef BENCHMARK_SUITE
+#define BENCHMARK_SUITE
+
+#include "engine.h"
+#include "text.h"
+#include "snake.h"
+#include "watermelon.h"
+#include "scenes.h"
+
+// Micro-benchmarks for the per-frame hot paths, built with BENCHMARK set to true.
+// Each case reports the micros() taken by BENCHMARK_ITERATIONS calls over Serial as
+//   name,size,micros,baseline,result
+// and compares it against the PROGMEM baseline for that case. Only a recorded baseline
+// can FAIL. A case whose baseline is not recorded reports NEW, followed by a line
+//   row,{ BENCH_NAME, size, micros },
+// to paste over its entry in benchmarkBaselines.
+
+#ifndef BENCHMARK_ITERATIONS
+#define BENCHMARK_ITERATIONS 32
+#endif
+
+#ifndef BENCHMARK_MAX_REELS
+#ifdef __AVR__
+#define BENCHMARK_MAX_REELS 2 // The ReelBank is on the stack, more reels do not fit next to the engine in 2.5KB
+#else
+#define BENCHMARK_MAX_REELS 8
+#endif
+#endif
+
+#ifndef BENCHMARK_SERIAL_TIMEOUT
+#define BENCHMARK_SERIAL_TIMEOUT 5000 // ms to wait for the USB serial port to be opened
+#endif
+
+#ifndef BENCHMARK_MAX_BODIES
+#define BENCHMARK_MAX_BODIES 16
+#endif
+
+const byte BENCHMARK_THRESHOLD_PERCENT = 20; // Slower than baseline by more than this fails
+
+enum BenchmarkID {
+  BENCH_CONTROLLER_UPDATE,
+  BENCH_RUN_CONTROLS,
+  BENCH_REEL_UPDATE,
+  BENCH_REEL_RENDER,
+  BENCH_TRAIL_PUSH_HEAD,
+  BENCH_TRAIL_EXISTS,
+  BENCH_TRAIL_GAME_OVER,
+  BENCH_SNAKE_RENDER,
+  BENCH_ANIMATOR_UPDATE,
+  BENCH_ANIMATOR_RENDER,
+  BENCH_SPRITE_RAW,
+  BENCH_SPRITE_PACKED,
+  BENCH_COLLISION_MOVE,
+  BENCH_COLLISION_PAIRS,
+  BENCH_COUNT
+};
+
+const byte BENCHMARK_NAME_SIZE = 18; // Longest name and its terminator
+
+// In flash, as strings would otherwise be copied into RAM
+const char benchmarkNames[BENCH_COUNT][BENCHMARK_NAME_SIZE] PROGMEM = {
+  "controller_update",
+  "run_controls",
+  "reel_update",
+  "reel_render",
+  "trail_push_head",
+  "trail_exists",
+  "trail_game_over",
+  "snake_render",
+  "animator_update",
+  "animator_render",
+  "sprite_raw",
+  "sprite_packed",
+  "collision_move",
+  "collision_pairs"
+};
+
+struct BenchmarkBaseline {
+  byte id;
+  uint16_t size;
+  uint32_t micros; // For BENCHMARK_ITERATIONS calls
+};
+
+const uint32_t BENCHMARK_UNRECORDED = 0;
+
+// One row per case runAll() measures on an Arduboy (16MHz, BENCHMARK_ITERATIONS = 32,
+// BENCHMARK_MAX_REELS = 2, BENCHMARK_MAX_BODIES = 16, BAND_RENDERING true). Rows still BENCHMARK_UNRECORDED
+// have not been measured on device yet and report NEW until their row is pasted in.
+const BenchmarkBaseline benchmarkBaselines[] PROGMEM = {
+  { BENCH_CONTROLLER_UPDATE, 1, BENCHMARK_UNRECORDED },
+  { BENCH_RUN_CONTROLS, 1, BENCHMARK_UNRECORDED },
+  { BENCH_RUN_CONTROLS, 2, BENCHMARK_UNRECORDED },
+  { BENCH_RUN_CONTROLS, 4, BENCHMARK_UNRECORDED },
+  { BENCH_REEL_UPDATE, 1, BENCHMARK_UNRECORDED },
+  { BENCH_REEL_RENDER, 1, BENCHMARK_UNRECORDED },
+  { BENCH_REEL_UPDATE, 2, BENCHMARK_UNRECORDED },
+  { BENCH_REEL_RENDER, 2, BENCHMARK_UNRECORDED },
+  { BENCH_TRAIL_PUSH_HEAD, 3, BENCHMARK_UNRECORDED },
+  { BENCH_TRAIL_EXISTS, 3, BENCHMARK_UNRECORDED },
+  { BENCH_TRAIL_GAME_OVER, 3, BENCHMARK_UNRECORDED },
+  { BENCH_TRAIL_PUSH_HEAD, 10, BENCHMARK_UNRECORDED },
+  { BENCH_TRAIL_EXISTS, 10, BENCHMARK_UNRECORDED },
+  { BENCH_TRAIL_GAME_OVER, 10, BENCHMARK_UNRECORDED },
+  { BENCH_TRAIL_PUSH_HEAD, 25, BENCHMARK_UNRECORDED },
+  { BENCH_TRAIL_EXISTS, 25, BENCHMARK_UNRECORDED },
+  { BENCH_TRAIL_GAME_OVER, 25, BENCHMARK_UNRECORDED },
+  { BENCH_TRAIL_PUSH_HEAD, 50, BENCHMARK_UNRECORDED },
+  { BENCH_TRAIL_EXISTS, 50, BENCHMARK_UNRECORDED },
+  { BENCH_TRAIL_GAME_OVER, 50, BENCHMARK_UNRECORDED },
+  { BENCH_TRAIL_PUSH_HEAD, 100, BENCHMARK_UNRECORDED },
+  { BENCH_TRAIL_EXISTS, 100, BENCHMARK_UNRECORDED },
+  { BENCH_TRAIL_GAME_OVER, 100, BENCHMARK_UNRECORDED },
+  { BENCH_SNAKE_RENDER, 10, BENCHMARK_UNRECORDED },
+  { BENCH_SNAKE_RENDER, 16, BENCHMARK_UNRECORDED },
+  { BENCH_SNAKE_RENDER, 32, BENCHMARK_UNRECORDED },
+  { BENCH_SNAKE_RENDER, 64, BENCHMARK_UNRECORDED },
+  { BENCH_ANIMATOR_UPDATE, 1, BENCHMARK_UNRECORDED },
+  { BENCH_ANIMATOR_RENDER, 1, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_RAW, 0, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_PACKED, 0, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_RAW, 1, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_PACKED, 1, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_RAW, 2, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_PACKED, 2, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_RAW, 3, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_PACKED, 3, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_RAW, 4, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_PACKED, 4, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_RAW, 5, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_PACKED, 5, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_RAW, 6, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_PACKED, 6, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_RAW, 7, BENCHMARK_UNRECORDED },
+  { BENCH_SPRITE_PACKED, 7, BENCHMARK_UNRECORDED },
+  { BENCH_COLLISION_MOVE, 4, BENCHMARK_UNRECORDED },
+  { BENCH_COLLISION_PAIRS, 4, BENCHMARK_UNRECORDED },
+  { BENCH_COLLISION_MOVE, 8, BENCHMARK_UNRECORDED },
+  { BENCH_COLLISION_PAIRS, 8, BENCHMARK_UNRECORDED },
+  { BENCH_COLLISION_MOVE, 16, BENCHMARK_UNRECORDED },
+  { BENCH_COLLISION_PAIRS, 16, BENCHMARK_UNRECORDED },
+  { BENCH_COUNT, 0, 0 } // End marker
+};
+
+class BenchmarkRunner{
+  public:
+    Engine* engine;
+    byte numFailures = 0;
+    byte numNew = 0;
+
+    // The benchmark build runs this as the engine's Game, so no RAM goes to the real one
+    static const byte MAX_CONTROLS = 4; // runControls() fills the list up to this
+    static const byte MAX_RENDERABLES = 1;
+
+    BenchmarkRunner(Engine* inEngine) : engine(inEngine) {}
+
+    // Called from the engine's setup(), never returns
+    void begin(){
+      runAll();
+      halt();
+    }
+
+    void update(){}
+
+    template <typename Func>
+    uint32_t measure(Func func){
+      uint32_t start = micros();
+      for( uint16_t i = 0; i < BENCHMARK_ITERATIONS; i++ ){
+        func();
+      }
+      return micros() - start;
+    }
+
+    uint32_t findBaseline(byte inID, uint16_t inSize){
+      for( const BenchmarkBaseline* entry = benchmarkBaselines; ; entry++ ){
+        byte id = pgm_read_byte(&entry->id);
+        if( id == BENCH_COUNT ){
+          return BENCHMARK_UNRECORDED;
+        }
+        if( id == inID && pgm_read_word(&entry->size) == inSize ){
+          return pgm_read_dword(&entry->micros);
+        }
+      }
+    }
+
+    void report(byte inID, uint16_t inSize, uint32_t inMicros){
+      uint32_t baseline = findBaseline(inID, inSize);
+      const char* result = "PASS";
+      if( baseline == BENCHMARK_UNRECORDED ){
+        result = "NEW";
+        numNew++;
+      }
+      else if( inMicros * 100 > baseline * (100 + BENCHMARK_THRESHOLD_PERCENT) ){
+        result = "FAIL";
+        numFailures++;
+      }
+      Serial.print(reinterpret_cast<const __FlashStringHelper*>(benchmarkNames[inID]));
+      Serial.print(',');
+      Serial.print(inSize);
+      Serial.print(',');
+      Serial.print(inMicros);
+      Serial.print(',');
+      Serial.print(baseline);
+      Serial.print(',');
+      Serial.println(result);
+      if( baseline == BENCHMARK_UNRECORDED ){
+        printBaselineRow(inID, inSize, inMicros);
+      }
+    }
+
+    // row,{ BENCH_NAME, size, micros }, with the enum name rebuilt from the case name
+    void printBaselineRow(byte inID, uint16_t inSize, uint32_t inMicros){
+      Serial.print(F("row,{ BENCH_"));
+      for( const char* c = benchmarkNames[inID]; pgm_read_byte(c) != 0; c++ ){
+        char letter = pgm_read_byte(c);
+        Serial.print((char)(letter >= 'a' && letter <= 'z' ? letter - 'a' + 'A' : letter));
+      }
+      Serial.print(F(", "));
+      Serial.print(inSize);
+      Serial.print(F(", "));
+      Serial.print(inMicros);
+      Serial.println(F(" },"));
+    }
+
+    void runAll(){
+      // The 32u4's USB serial only comes up once the host opens the port, anything
+      // printed before that is lost. Run anyway after the timeout, the totals still show.
+      Serial.begin(9600);
+      uint32_t start = millis();
+      while( !Serial && millis() - start < BENCHMARK_SERIAL_TIMEOUT ){}
+      Serial.println(F("name,size,micros,baseline,result"));
+      runController();
+      runControls();
+      for( byte reels = 1; reels <= BENCHMARK_MAX_REELS; reels <<= 1 ){
+        runReels(reels);
+      }
+      static const byte trailLengths[] = {3, 10, 25, 50, 100};
+      for( byte i = 0; i < sizeof(trailLengths); i++ ){
+        runTrail(trailLengths[i]);
+      }
+      static const byte gridSizes[] = {10, 16, 32, 64};
+      for( byte i = 0; i < sizeof(gridSizes); i++ ){
+        runSnakeRender(gridSizes[i]);
+      }
+      runAnimator();
+      for( byte sprite = 0; sprite < watermelonAssets.getNumSprites(); sprite++ ){
+        runSprite(sprite);
+      }
+      for( byte bodies = 4; bodies <= BENCHMARK_MAX_BODIES; bodies <<= 1 ){
+        runCollisions(bodies);
+      }
+    }
+
+    // Show the totals and stop, the benchmark build does not run the game.
+    // NEW cases do not fail, they have no baseline to compare against.
+    void halt(){
+      CachedNumber failures;
+      CachedNumber fresh;
+      auto drawTotals = [&](const RenderTarget& screen){
+        drawText(screen, 0, 0, numFailures > 0 ? "BENCH FAILED" : "BENCH PASSED");
+        drawText(screen, 0, 16, "FAIL");
+        drawText(screen, 36, 16, failures.format(numFailures));
+        drawText(screen, 0, 24, "NEW");
+        drawText(screen, 36, 24, fresh.format(numNew));
+      };
+#if BAND_RENDERING
+      memset(engine -> band, 0, WIDTH); // The render cases leave it dirty
+      for( int8_t page = 0; page < HEIGHT / 8; page++ ){
+        RenderTarget screen = {engine -> band, page, 1};
+        drawTotals(screen);
+        engine -> sendBand();
+      }
+#else
+      engine -> arduboy.clear();
+      drawTotals(screenTarget(&engine -> arduboy));
+      engine -> arduboy.display();
+#endif
+      while( true ){}
+    }
+
+  private:
+    static void noControl(void* /*data*/){}
+    static void noPair(byte /*a*/, byte /*b*/, void* /*data*/){}
+
+    // One frame's drawing the way the game does it: into the framebuffer, or page by page
+    // into the band, which is all a BAND_RENDERING build has
+    template <typename Func>
+    void drawFrame(Func draw){
+#if BAND_RENDERING
+      for( int8_t page = 0; page < HEIGHT / 8; page++ ){
+        RenderTarget target = {engine -> band, page, 1};
+        draw(target);
+      }
+#else
+      draw(screenTarget(&engine -> arduboy));
+#endif
+    }
+
+    // Skips the pages inRenderable does not touch, as the RenderList does
+    void renderFrame(Renderable& inRenderable){
+      drawFrame([&](const RenderTarget& target){
+        if( touchesTarget(inRenderable, target) ){
+          inRenderable.renderTo(target);
+        }
+      });
+    }
+
+    void runController(){
+      Controller& controller = engine -> controller;
+      byte buttons = 0;
+      report(BENCH_CONTROLLER_UPDATE, 1, measure([&]{
+        buttons ^= A_BUTTON | UP_BUTTON;
+        controller.update(buttons);
+      }));
+    }
+
+    void runControls(){
+      ControllerList* list = engine -> controllerList;
+      for( byte count = 1; count <= list -> maxControls; count <<= 1 ){
+        list -> clearControls();
+        for( byte i = 0; i < count; i++ ){
+          list -> addControl(BUTTON_HELD, A_BUTTON, &BenchmarkRunner::noControl, nullptr);
+        }
+        report(BENCH_RUN_CONTROLS, count, measure([&]{
+          list -> runControls();
+        }));
+      }
+      list -> clearControls();
+    }
+
+    // The bank is on the stack and torn down on return, like a scene's
+    void runReels(byte inCount){
+      static int symbolIDs[] = {0,1,2,3,4,5,6,7};
+      ReelBank<BENCHMARK_MAX_REELS> reels(&engine -> arduboy, engine -> controllerList);
+      for( byte i = 0; i < inCount; i++ ){
+        Reel* reel = reels.addReel(&engine -> tweens, nullptr, symbolIDs, 8, 16, 3, 5, 10, 3, 120, 300);
+        reel -> setPosition(i * 16, 24);
+        reel -> setSymbolPack(&watermelonAssets);
+      }
+      reels.playButton();
+      report(BENCH_REEL_UPDATE, inCount, measure([&]{
+        engine -> tweens.update();
+        reels.update();
+      }));
+      report(BENCH_REEL_RENDER, inCount, measure([&]{
+        renderFrame(reels);
+      }));
+    }
+
+    void runTrail(byte inLength){
+      SnakeTrail trail;
+      for( byte i = 0; i < inLength; i++ ){
+        trail.increaseLength();
+        trail.pushHead(i % 10, i / 10);
+      }
+      int step = 0;
+      report(BENCH_TRAIL_PUSH_HEAD, inLength, measure([&]{
+        step++;
+        trail.pushHead(step % 10, (step / 10) % 10);
+      }));
+      volatile bool sink;
+      report(BENCH_TRAIL_EXISTS, inLength, measure([&]{
+        sink = trail.trailExists(-1, -1); // Miss, so every segment is checked
+      }));
+      report(BENCH_TRAIL_GAME_OVER, inLength, measure([&]{
+        sink = trail.checkGameOver();
+      }));
+    }
+
+    void runSnakeRender(byte inGridSize){
+      Snake snake(engine -> controllerList, &engine -> arduboy, &engine -> random);
+      snake.gridsize = inGridSize;
+      snake.blocksize = max(1, 60 / inGridSize);
+      report(BENCH_SNAKE_RENDER, inGridSize, measure([&]{
+        renderFrame(snake);
+      }));
+    }
+
+    // drawBitmap of a raw tile against the tile drawn from the pack, which decodes on the
+    // fly when the packer compressed it. Sizes are sprite indices in watermelonPack. The pack
+    // keeps no raw copy of a compressed tile, so its raw case draws the raw tile it is
+    // encoded against, which is the same size.
+    void runSprite(byte inSprite){
+      SpriteInfo info = watermelonAssets.getSprite(inSprite);
+      byte rawSprite = info.flags & ASSET_FLAG_COMPRESSED ? (info.flags & ASSET_BASE_MASK) - 1 : inSprite;
+      const byte* raw = rawSprite < watermelonAssets.getNumSprites() ? watermelonAssets.getFrame(rawSprite, 0) : nullptr;
+      if( raw != nullptr ){
+        report(BENCH_SPRITE_RAW, inSprite, measure([&]{
+          drawFrame([&](const RenderTarget& screen){
+            drawBitmap(screen, 20, 21, raw, info.width, info.height);
+          });
+        }));
+      }
+      report(BENCH_SPRITE_PACKED, inSprite, measure([&]{
+        drawFrame([&](const RenderTarget& screen){
+          watermelonAssets.draw(screen, 20, 21, inSprite, 0);
+        });
+      }));
+    }
+
+    // 8x8 boxes scattered over the screen, one nudged per move
+    void runCollisions(byte inBodies){
+      FixedCollisionGrid<BENCHMARK_MAX_BODIES> grid;
+      Random& random = engine -> random;
+      for( byte i = 0; i < inBodies; i++ ){
+        grid.add(random.nextBelow(WIDTH - 8), random.nextBelow(HEIGHT - 8), 8, 8);
+      }
+      byte body = 0;
+      report(BENCH_COLLISION_MOVE, inBodies, measure([&]{
+        body = (body + 1) % inBodies;
+        grid.move(body, grid.bodies[body].x ^ 1, grid.bodies[body].y ^ 2);
+      }));
+      report(BENCH_COLLISION_PAIRS, inBodies, measure([&]{
+        grid.forEachPair(&BenchmarkRunner::noPair, nullptr);
+      }));
+    }
+
+    void runAnimator(){
+      Animator animator(&engine -> arduboy, nullptr, 16, 1, 5);
+      animator.setSprite(&watermelonAssets, WATERMELON_TILE000);
+      animator.startAnimation();
+      report(BENCH_ANIMATOR_UPDATE, 1, measure([&]{
+        animator.update();
+      }));
+      report(BENCH_ANIMATOR_RENDER, 1, measure([&]{
+        renderFrame(animator);
+      }));
+    }
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef BITSTREAM
+#define BITSTREAM
+
+// Number of bits needed to hold 0..inMaxValue
+inline byte bitsFor(unsigned int inMaxValue){
+  byte bits = 1;
+  while( (inMaxValue >> bits) != 0 ){
+    bits++;
+  }
+  return bits;
+}
+
+// Packs values LSB first into a byte buffer, sets bOverflow instead of writing past the end
+class BitWriter{
+  public:
+    byte* buffer;
+    uint16_t capacity; // In bytes
+    uint16_t bitPos = 0;
+    bool bOverflow = false;
+
+    BitWriter(byte* inBuffer, uint16_t inCapacity) : buffer(inBuffer), capacity(inCapacity){
+      memset(buffer, 0, capacity);
+    }
+
+    void write(uint16_t inValue, byte inBits){
+      if( bitPos + inBits > capacity * 8 ){
+        bOverflow = true;
+        return;
+      }
+      for( byte bit = 0; bit < inBits; bit++ ){
+        if( inValue & (1u << bit) ){
+          buffer[bitPos >> 3] |= 1 << (bitPos & 7);
+        }
+        bitPos++;
+      }
+    }
+
+    void writeBool(bool inValue){
+      write(inValue ? 1 : 0, 1);
+    }
+
+    // One flag bit when inValue matches inDefault, otherwise the flag and inBits of signed value
+    void writeDelta(int inValue, int inDefault, byte inBits){
+      if( inValue == inDefault ){
+        write(0, 1);
+      }
+      else{
+        write(1, 1);
+        write(static_cast<uint16_t>(inValue), inBits);
+      }
+    }
+
+    // Bytes used so far
+    byte length() const {
+      return (bitPos + 7) >> 3;
+    }
+};
+
+class BitReader{
+  public:
+    const byte* buffer;
+    uint16_t capacity; // In bytes
+    uint16_t bitPos = 0;
+    bool bOverflow = false;
+
+    BitReader(const byte* inBuffer, uint16_t inCapacity) : buffer(inBuffer), capacity(inCapacity){}
+
+    uint16_t read(byte inBits){
+      if( bitPos + inBits > capacity * 8 ){
+        bOverflow = true;
+        return 0;
+      }
+      uint16_t value = 0;
+      for( byte bit = 0; bit < inBits; bit++ ){
+        if( buffer[bitPos >> 3] & (1 << (bitPos & 7)) ){
+          value |= 1u << bit;
+        }
+        bitPos++;
+      }
+      return value;
+    }
+
+    bool readBool(){
+      return read(1) != 0;
+    }
+
+    // Counterpart of BitWriter::writeDelta, sign extends the stored value
+    int readDelta(int inDefault, byte inBits){
+      if( !readBool() ){
+        return inDefault;
+      }
+      uint16_t value = read(inBits);
+      if( inBits < 16 && (value & (1u << (inBits - 1))) ){
+        value |= 0xFFFF << inBits;
+      }
+      return static_cast<int16_t>(value);
+    }
+};
+
+#endif
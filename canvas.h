@@ -0,0 +1,183 @@
+#ifndef CANVAS
+#define CANVAS
+
+#include "renderstats.h"
+
+// A run of whole 8 pixel pages to draw into: the full framebuffer, or a band of it when
+// rendering a strip at a time. buffer holds numPages * WIDTH bytes starting at firstPage.
+struct RenderTarget {
+  uint8_t* buffer;
+  int8_t firstPage;
+  byte numPages;
+
+  bool hasPage(int inPage) const {
+    return inPage >= firstPage && inPage < firstPage + numPages;
+  }
+
+  uint8_t& column(int inPage, int inX) const {
+    return buffer[(inPage - firstPage) * WIDTH + inX];
+  }
+};
+
+// Whole framebuffer as a target
+inline RenderTarget screenTarget(Arduboy2Base* inArduboy){
+  RenderTarget target = {inArduboy -> getBuffer(), 0, HEIGHT / 8};
+  return target;
+}
+
+// The drawing below matches Arduboy2's WHITE drawing pixel for pixel, but writes through
+// a RenderTarget so the same calls can fill either the framebuffer or a band.
+
+// Walks a bitmap's bytes in page order over the target, ORing each one in at the right
+// column and page. Bytes off screen or outside the target are skipped.
+class BitmapCursor{
+  public:
+    BitmapCursor(const RenderTarget& inTarget, int inX, int inY, byte inWidth)
+      : target(inTarget), startX(inX), x(inX), endX(inX + inWidth), page(inY >> 3), shift(inY & 7) {}
+
+    void plot(byte inBits){
+      if( inBits != 0 && x >= 0 && x < WIDTH ){
+        if( target.hasPage(page) ){
+          uint8_t& column = target.column(page, x);
+          RENDER_STAT_WRITE(page, x, column, (uint8_t)(inBits << shift));
+          column |= inBits << shift;
+        }
+        if( shift != 0 && target.hasPage(page + 1) ){
+          uint8_t& column = target.column(page + 1, x);
+          RENDER_STAT_WRITE(page + 1, x, column, inBits >> (8 - shift));
+          column |= inBits >> (8 - shift);
+        }
+      }
+      if( ++x == endX ){
+        x = startX;
+        page++;
+      }
+    }
+
+  private:
+    const RenderTarget& target;
+    int startX;
+    int x;
+    int endX;
+    int8_t page;
+    byte shift;
+};
+
+// Same layout and result as Arduboy2::drawBitmap with WHITE, inBitmap in PROGMEM
+inline void drawBitmap(const RenderTarget& target, int inX, int inY, const uint8_t* inBitmap, byte inWidth, byte inHeight){
+  if( inX + inWidth < 0 || inX >= WIDTH || inY + inHeight < 0 || inY >= HEIGHT ){
+    return;
+  }
+  RENDER_STAT_CALL();
+  BitmapCursor cursor(target, inX, inY, inWidth);
+  uint16_t size = inWidth * ((inHeight + 7) >> 3);
+  for( uint16_t i = 0; i < size; i++ ){
+    cursor.plot(pgm_read_byte(&inBitmap[i]));
+  }
+}
+
+// Bits for rows inTop..inEnd-1, which must lie in one page
+inline byte pageRowMask(int inTop, int inEnd){
+  return (0xFF << (inTop & 7)) & (0xFF >> (((inTop | 7) + 1) - inEnd));
+}
+
+inline void drawFastVLine(const RenderTarget& target, int inX, int inY, int inHeight){
+  if( inX < 0 || inX >= WIDTH ){
+    return;
+  }
+  RENDER_STAT_CALL();
+  int top = max(inY, 0);
+  int bottom = min(inY + inHeight, (int)HEIGHT); // Exclusive
+  while( top < bottom ){
+    int page = top >> 3;
+    int pageEnd = min((page + 1) << 3, bottom);
+    if( target.hasPage(page) ){
+      RENDER_STAT_WRITE(page, inX, target.column(page, inX), pageRowMask(top, pageEnd));
+      target.column(page, inX) |= pageRowMask(top, pageEnd);
+    }
+    top = pageEnd;
+  }
+}
+
+inline void drawFastHLine(const RenderTarget& target, int inX, int inY, int inWidth){
+  if( inY < 0 || inY >= HEIGHT || !target.hasPage(inY >> 3) ){
+    return;
+  }
+  RENDER_STAT_CALL();
+  int left = max(inX, 0);
+  int right = min(inX + inWidth, (int)WIDTH);
+  byte bit = 1 << (inY & 7);
+  for( int x = left; x < right; x++ ){
+    RENDER_STAT_WRITE(inY >> 3, x, target.column(inY >> 3, x), bit);
+    target.column(inY >> 3, x) |= bit;
+  }
+}
+
+// A page at a time, ORing one mask across the columns instead of a line per column
+inline void fillRect(const RenderTarget& target, int inX, int inY, int inWidth, int inHeight){
+  int left = max(inX, 0);
+  int right = min(inX + inWidth, (int)WIDTH);
+  int top = max(inY, 0);
+  int bottom = min(inY + inHeight, (int)HEIGHT);
+  RENDER_STAT_CALL();
+  while( left < right && top < bottom ){
+    int page = top >> 3;
+    int pageEnd = min((page + 1) << 3, bottom);
+    if( target.hasPage(page) ){
+      byte mask = pageRowMask(top, pageEnd);
+      uint8_t* column = &target.column(page, left);
+      for( int x = left; x < right; x++ ){
+        RENDER_STAT_WRITE(page, x, *column, mask);
+        *column++ |= mask;
+      }
+    }
+    top = pageEnd;
+  }
+}
+
+inline void drawRect(const RenderTarget& target, int inX, int inY, int inWidth, int inHeight){
+  drawFastHLine(target, inX, inY, inWidth);
+  drawFastHLine(target, inX, inY + inHeight - 1, inWidth);
+  drawFastVLine(target, inX, inY, inHeight);
+  drawFastVLine(target, inX + inWidth - 1, inY, inHeight);
+}
+
+// The same pixels as a drawRect around every cell of an inCols x inRows grid of inCell
+// squares. Neighbouring cells' edges join up, so this is two lines per row and per column
+// rather than four per cell.
+inline void drawCellGrid(const RenderTarget& target, int inX, int inY, int inCols, int inRows, int inCell){
+  for( int row = 0; row < inRows; row++ ){
+    drawFastHLine(target, inX, inY + row * inCell, inCols * inCell);
+    drawFastHLine(target, inX, inY + row * inCell + inCell - 1, inCols * inCell);
+  }
+  for( int col = 0; col < inCols; col++ ){
+    drawFastVLine(target, inX + col * inCell, inY, inRows * inCell);
+    drawFastVLine(target, inX + col * inCell + inCell - 1, inY, inRows * inCell);
+  }
+}
+
+// Same midpoint walk as Arduboy2::fillCircle
+inline void fillCircle(const RenderTarget& target, int inX, int inY, int inRadius){
+  drawFastVLine(target, inX, inY - inRadius, 2 * inRadius + 1);
+  int f = 1 - inRadius;
+  int ddFx = 1;
+  int ddFy = -2 * inRadius;
+  int x = 0;
+  int y = inRadius;
+  while( x < y ){
+    if( f >= 0 ){
+      y--;
+      ddFy += 2;
+      f += ddFy;
+    }
+    x++;
+    ddFx += 2;
+    f += ddFx;
+    drawFastVLine(target, inX + x, inY - y, 2 * y + 1);
+    drawFastVLine(target, inX + y, inY - x, 2 * x + 1);
+    drawFastVLine(target, inX - x, inY - y, 2 * y + 1);
+    drawFastVLine(target, inX - y, inY - x, 2 * x + 1);
+  }
+}
+
+#endif
@@ -0,0 +1,263 @@
+#ifndef COLLISION
+#define COLLISION
+
+// The screen is hashed into a uniform grid of 16x16 pixel cells, 8 x 4 of them.
+// Each cell holds a bit per body overlapping it, so a query ORs the masks of the few cells
+// it covers and only tests the bodies it finds there.
+const byte COLLISION_CELL_SHIFT = 4;
+const byte COLLISION_COLUMNS = WIDTH >> COLLISION_CELL_SHIFT;
+const byte COLLISION_ROWS = HEIGHT >> COLLISION_CELL_SHIFT;
+const byte COLLISION_MAX_BODIES = 32; // Bits in a BodyMask
+const byte NO_BODY = 0xFF;
+
+typedef uint32_t BodyMask;
+
+// Broadphase for moving axis aligned boxes, e.g. one per Animator. Bodies are handles;
+// callers keep their own table from handle to object. Boxes off the screen are kept in
+// the edge cells, so they still collide, just without the speed up.
+class CollisionGrid{
+  public:
+    typedef void (*PairFunction)(byte, byte, void*);
+    struct Body {
+      int16_t x;
+      int16_t y;
+      byte width;
+      byte height;
+      byte columns; // First | last << 4
+      byte rows;    // First | last << 4
+    };
+
+    Body* bodies; // Storage owned by FixedCollisionGrid
+    byte maxBodies;
+    BodyMask used = 0;
+    bool bOverflow = false; // Set when an add did not fit
+
+    // Returns the body handle, or NO_BODY (setting bOverflow) when full
+    byte add(int16_t inX, int16_t inY, byte inWidth, byte inHeight){
+      for( byte body = 0; body < maxBodies; body++ ){
+        if( !(used & bodyBit(body)) ){
+          used |= bodyBit(body);
+          Body& entry = bodies[body];
+          entry.width = inWidth;
+          entry.height = inHeight;
+          entry.columns = spanOf(inX, inWidth, COLLISION_COLUMNS);
+          entry.rows = spanOf(inY, inHeight, COLLISION_ROWS);
+          entry.x = inX;
+          entry.y = inY;
+          setCells(body, true);
+          return body;
+        }
+      }
+      bOverflow = true;
+      return NO_BODY;
+    }
+
+    void remove(byte inBody){
+      if( isUsed(inBody) ){
+        setCells(inBody, false);
+        used &= ~bodyBit(inBody);
+      }
+    }
+
+    // Only touches the cells when the box crosses into different ones
+    void move(byte inBody, int16_t inX, int16_t inY){
+      if( !isUsed(inBody) ){
+        return;
+      }
+      Body& entry = bodies[inBody];
+      byte columns = spanOf(inX, entry.width, COLLISION_COLUMNS);
+      byte rows = spanOf(inY, entry.height, COLLISION_ROWS);
+      if( columns != entry.columns || rows != entry.rows ){
+        setCells(inBody, false);
+        entry.columns = columns;
+        entry.rows = rows;
+        setCells(inBody, true);
+      }
+      entry.x = inX;
+      entry.y = inY;
+    }
+
+    void clear(){
+      used = 0;
+      for( byte cell = 0; cell < COLLISION_COLUMNS * COLLISION_ROWS; cell++ ){
+        cells[cell] = 0;
+      }
+    }
+
+    // Bodies containing the pixel
+    BodyMask queryPoint(int16_t inX, int16_t inY) const {
+      return queryRect(inX, inY, 1, 1);
+    }
+
+    // Bodies overlapping the box
+    BodyMask queryRect(int16_t inX, int16_t inY, byte inWidth, byte inHeight) const {
+      BodyMask candidates = cellMask(spanOf(inX, inWidth, COLLISION_COLUMNS), spanOf(inY, inHeight, COLLISION_ROWS));
+      BodyMask hits = 0;
+      while( candidates != 0 ){
+        byte body = popBody(candidates);
+        const Body& entry = bodies[body];
+        if( overlaps(entry, inX, inY, inWidth, inHeight) ){
+          hits |= bodyBit(body);
+        }
+      }
+      return hits;
+    }
+
+    // Other bodies overlapping inBody
+    BodyMask overlapping(byte inBody) const {
+      if( !isUsed(inBody) ){
+        return 0;
+      }
+      const Body& entry = bodies[inBody];
+      return queryRect(entry.x, entry.y, entry.width, entry.height) & ~bodyBit(inBody);
+    }
+
+    // Calls inFunc once for each overlapping pair, lower handle first. Returns the pair count.
+    byte forEachPair(PairFunction inFunc, void* inArgs) const {
+      byte numPairs = 0;
+      BodyMask remaining = used;
+      while( remaining != 0 ){
+        byte body = popBody(remaining);
+        const Body& entry = bodies[body];
+        BodyMask later = ~((bodyBit(body) << 1) - 1); // Bits above body, empty for the top bit
+        BodyMask candidates = cellMask(entry.columns, entry.rows) & later;
+        while( candidates != 0 ){
+          byte other = popBody(candidates);
+          const Body& otherEntry = bodies[other];
+          if( overlaps(entry, otherEntry.x, otherEntry.y, otherEntry.width, otherEntry.height) ){
+            inFunc(body, other, inArgs);
+            numPairs++;
+          }
+        }
+      }
+      return numPairs;
+    }
+
+    bool isUsed(byte inBody) const {
+      return inBody < maxBodies && (used & bodyBit(inBody));
+    }
+
+    static BodyMask bodyBit(byte inBody){
+      return (BodyMask)1 << inBody;
+    }
+
+    // Lowest body in the mask, removed from it. The mask must not be empty.
+    static byte popBody(BodyMask& mask){
+      byte body = 0;
+      while( !(mask & bodyBit(body)) ){
+        body++;
+      }
+      mask &= ~bodyBit(body);
+      return body;
+    }
+
+  protected:
+    CollisionGrid(Body* inBodies, byte inMaxBodies) : bodies(inBodies), maxBodies(inMaxBodies) {
+      clear();
+    }
+
+  private:
+    BodyMask cells[COLLISION_COLUMNS * COLLISION_ROWS];
+
+    // First and last cell a span covers, clamped to the grid, packed as first | last << 4
+    static byte spanOf(int16_t inStart, byte inLength, byte inCells){
+      int16_t first = inStart >> COLLISION_CELL_SHIFT;
+      int16_t last = (inStart + max((int)inLength, 1) - 1) >> COLLISION_CELL_SHIFT;
+      first = constrain(first, 0, inCells - 1);
+      last = constrain(last, 0, inCells - 1);
+      return first | (last << 4);
+    }
+
+    static bool overlaps(const Body& inBody, int16_t inX, int16_t inY, byte inWidth, byte inHeight){
+      return inBody.x < inX + inWidth && inX < inBody.x + inBody.width &&
+             inBody.y < inY + inHeight && inY < inBody.y + inBody.height;
+    }
+
+    BodyMask cellMask(byte inColumns, byte inRows) const {
+      BodyMask mask = 0;
+      for( byte row = inRows & 0x0F; row <= inRows >> 4; row++ ){
+        for( byte column = inColumns & 0x0F; column <= inColumns >> 4; column++ ){
+          mask |= cells[row * COLLISION_COLUMNS + column];
+        }
+      }
+      return mask;
+    }
+
+    void setCells(byte inBody, bool bSet){
+      const Body& entry = bodies[inBody];
+      for( byte row = entry.rows & 0x0F; row <= entry.rows >> 4; row++ ){
+        for( byte column = entry.columns & 0x0F; column <= entry.columns >> 4; column++ ){
+          if( bSet ){
+            cells[row * COLLISION_COLUMNS + column] |= bodyBit(inBody);
+          }
+          else{
+            cells[row * COLLISION_COLUMNS + column] &= ~bodyBit(inBody);
+          }
+        }
+      }
+    }
+};
+
+template <byte MAX_BODIES>
+class FixedCollisionGrid : public CollisionGrid{
+  public:
+    static_assert(MAX_BODIES <= COLLISION_MAX_BODIES, "A BodyMask holds at most 32 bodies");
+    static const byte CAPACITY = MAX_BODIES;
+
+    FixedCollisionGrid() : CollisionGrid(entries, MAX_BODIES){}
+
+  private:
+    Body entries[MAX_BODIES];
+};
+
+// The same hashing at tile resolution for games on a tile board, where a box per tile
+// would not fit: a count per tile of how many things are on it, so "is anything here"
+// and "is more than one thing here" are single lookups.
+class TileOccupancy{
+  public:
+    // Tiles off the board are ignored
+    void add(int inColumn, int inRow){
+      if( isOnBoard(inColumn, inRow) ){
+        counts[inRow * columns + inColumn]++;
+      }
+    }
+
+    void remove(int inColumn, int inRow){
+      if( isOnBoard(inColumn, inRow) && counts[inRow * columns + inColumn] > 0 ){
+        counts[inRow * columns + inColumn]--;
+      }
+    }
+
+    byte count(int inColumn, int inRow) const {
+      return isOnBoard(inColumn, inRow) ? counts[inRow * columns + inColumn] : 0;
+    }
+
+    void clear(){
+      memset(counts, 0, columns * rows);
+    }
+
+  protected:
+    TileOccupancy(byte* inCounts, byte inColumns, byte inRows) : counts(inCounts), columns(inColumns), rows(inRows) {
+      clear();
+    }
+
+  private:
+    byte* counts; // Storage owned by FixedTileOccupancy
+    byte columns;
+    byte rows;
+
+    bool isOnBoard(int inColumn, int inRow) const {
+      return inColumn >= 0 && inColumn < columns && inRow >= 0 && inRow < rows;
+    }
+};
+
+template <byte COLUMNS, byte ROWS>
+class FixedTileOccupancy : public TileOccupancy{
+  public:
+    FixedTileOccupancy() : TileOccupancy(tiles, COLUMNS, ROWS){}
+
+  private:
+    byte tiles[COLUMNS * ROWS];
+};
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef CONTROLLER
 #define CONTROLLER
 
+#include "inputqueue.h"
+#include "bitstream.h"
+
 enum ControllerID {
   BUTTON_JUST_PRESSED,
   BUTTON_JUST_RELEASED,
@@ -24,18 +27,24 @@ class Controller{
 
     byte frameCounter = 0;
     byte repeatDelayFrames = 10;
-    byte buttonTimers[8] = {0,0,0,0,0,0,0,0};
-    byte buttonMemorySize = 10;
-    byte buttonMemory[10];
+    byte buttonTimers[8] = {0,0,0,0,0,0,0,0}; // One per button bit
+    byte buttonMemorySize;
+    byte* buttonMemory; // Storage owned by FixedController
     byte buttonMemoryFrames = 30;
     byte buttonMemoryCurrentFrames = 0;
     bool memoryCleared = true;
 
-    Controller(){};
-    Controller(byte inRepeatDelayFrames){
+    byte queueButtons = 0;     // Last physical state drained from an InputQueue
+    uint16_t inputLatency = 0; // Age in ms of the oldest edge drained on the last update that had one
+    byte inputDropped = 0;     // The queue's count of edges it had no room for
+
+  protected:
+    Controller(byte* inMemory, byte inMemorySize, byte inRepeatDelayFrames) : buttonMemorySize(inMemorySize), buttonMemory(inMemory){
       repeatDelayFrames = inRepeatDelayFrames;
     };
 
+  public:
+
     void setRepeatDelay(byte inFrames){
       repeatDelayFrames = inFrames;
     }
@@ -94,6 +103,30 @@ class Controller{
       }
     }
 
+    // Drains the edges sampled since the last frame. A tap that was pressed and released
+    // between two frames is still reported as pressed for this frame, and so is a button
+    // released and pressed again between two frames, although it reads as held throughout.
+    // Edges still act on the next frame, so this catches more input rather than acting on it
+    // sooner; inputLatency shows how long the oldest edge waited.
+    void update(InputQueue& inQueue){
+      byte state = queueButtons;
+      byte taps = 0; // Every button that went down during the drain
+      bool first = true;
+      InputEvent event;
+      while( inQueue.pop(event) ){
+        if( first ){
+          inputLatency = (uint16_t)millis() - event.stamp;
+          first = false;
+        }
+        taps |= event.buttons & ~state;
+        state = event.buttons;
+      }
+      queueButtons = state;
+      inputDropped = inQueue.dropped;
+      update(state | taps);
+      currPressed |= taps;
+    }
+
     bool isID(ControllerID inID, byte buttonToCheck, byte inFrames = 1){
       bool toReturn = false;
       switch(inID){
@@ -176,6 +209,23 @@ class Controller{
       }
     }
 
+    // Repeat timers and settings, the button state itself is re-read on the next update
+    void save(BitWriter& writer){
+      writer.write(frameCounter, 8);
+      writer.writeDelta(repeatDelayFrames, 10, 9);
+      for( byte bit = 0; bit < 8; bit++ ){
+        writer.writeDelta(buttonTimers[bit], 0, 9);
+      }
+    }
+
+    void restore(BitReader& reader){
+      frameCounter = reader.read(8);
+      repeatDelayFrames = reader.readDelta(10, 9);
+      for( byte bit = 0; bit < 8; bit++ ){
+        buttonTimers[bit] = reader.readDelta(0, 9);
+      }
+    }
+
     String memoryPrint(){
       String toReturn = "";
       for( byte memoryIndex=0; memoryIndex < buttonMemorySize; memoryIndex++){
@@ -194,6 +244,7 @@ class Controller{
       string += String(currRepeating, BIN) + String("\n");
       string += String(buttonMemoryCurrentFrames) + String("\n");
       string += String(memoryPrint()) + String("\n");
+      string += String("L") + String(inputLatency) + String(" D") + String(inputDropped) + String("\n");
       return string;
     }
 
@@ -204,31 +255,45 @@ class Controller{
 
 };
 
+// Controller with room for MEMORY_SIZE remembered button combos
+template <byte MEMORY_SIZE = 10>
+class FixedController : public Controller{
+  public:
+    FixedController(byte inRepeatDelayFrames = 10) : Controller(memory, MEMORY_SIZE, inRepeatDelayFrames){}
+
+  private:
+    byte memory[MEMORY_SIZE];
+};
+
 class ControllerList{
   public:
     typedef void (*ControlFunction)(void*);
-    Controller* controller;
+    struct ControlEntry {
+      byte id;
+      byte control;
+      ControlFunction func;
+      void* args;
+    };
 
-    static const int MAX_CONTROLS = 12;
-    byte listIDs[MAX_CONTROLS];
-    byte listControls[MAX_CONTROLS];
-    ControlFunction funcControls[MAX_CONTROLS];
-    void* funcArgs[MAX_CONTROLS];
+    Controller* controller;
+    ControlEntry* controls; // Storage owned by FixedControllerList
+    byte maxControls;
     byte numControls = 0;
+    bool bOverflow = false; // Set when an addControl did not fit
 
-
-    ControllerList(Controller* inController){
-      controller = inController;
-    }
-
-    void addControl(byte inID, byte inControl, ControlFunction inFunc, void* inArgs) {
-      if (numControls < MAX_CONTROLS) {
-          listIDs[numControls] = inID;
-          listControls[numControls] = inControl;
-          funcControls[numControls] = inFunc;
-          funcArgs[numControls] = inArgs;
-          numControls++;
+    // Returns false, and sets bOverflow, when the list is full
+    bool addControl(byte inID, byte inControl, ControlFunction inFunc, void* inArgs) {
+      if (numControls >= maxControls) {
+          bOverflow = true;
+          return false;
       }
+      ControlEntry& entry = controls[numControls];
+      entry.id = inID;
+      entry.control = inControl;
+      entry.func = inFunc;
+      entry.args = inArgs;
+      numControls++;
+      return true;
     }
 
     void clearControls() {
@@ -237,12 +302,28 @@ class ControllerList{
 
     void runControls() {
       for (byte controlIndex = 0; controlIndex < numControls; ++controlIndex) {
-        if (controller->isID(listIDs[controlIndex], listControls[controlIndex], 1)) {
-            funcControls[controlIndex](funcArgs[controlIndex]);
+        const ControlEntry& entry = controls[controlIndex];
+        if (controller->isID(entry.id, entry.control, 1)) {
+            entry.func(entry.args);
         }
       }
     }
 
+  protected:
+    ControllerList(Controller* inController, ControlEntry* inControls, byte inMaxControls)
+      : controller(inController), controls(inControls), maxControls(inMaxControls) {}
+};
+
+// ControllerList with room for MAX_CONTROLS handlers
+template <byte MAX_CONTROLS>
+class FixedControllerList : public ControllerList{
+  public:
+    static const byte CAPACITY = MAX_CONTROLS;
+
+    FixedControllerList(Controller* inController) : ControllerList(inController, entries, MAX_CONTROLS){}
+
+  private:
+    ControlEntry entries[MAX_CONTROLS];
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,214 @@
+#ifndef ENGINE
+#define ENGINE
+
+#include "gameengine.h"
+#include "controller.h"
+#include "tween.h"
+#include "snapshot.h"
+#include "particles.h"
+#include "random.h"
+#include "scheduler.h"
+#include "mirror.h"
+#include "collision.h"
+
+#ifndef DEBUG
+#define DEBUG false
+#endif
+
+// true renders the screen one 8 pixel page at a time into a WIDTH byte band and streams
+// each band to the display, instead of drawing a whole frame into Arduboy2's 1KB buffer.
+// The RenderList is replayed once per page, renderables outside the page are skipped.
+// The engine then holds an Arduboy2Base: Arduboy2's text printing (and so its vtable)
+// draws into the framebuffer, and would keep the 1KB buffer linked in for nothing.
+// The DEBUG print needs that text printing, so it is compiled out in this mode.
+// On by default: the engine and the 1KB buffer do not both fit in the 32u4's 2.5KB.
+#ifndef BAND_RENDERING
+#define BAND_RENDERING true
+#endif
+
+// true streams each frame to tools/viewer.py over USB serial and takes buttons from it
+#ifndef SERIAL_VIEWER
+#define SERIAL_VIEWER false
+#endif
+
+#if SERIAL_VIEWER && RENDER_STATS
+#error "SERIAL_VIEWER and RENDER_STATS both use Serial, enable one at a time"
+#endif
+
+// Everything one running game needs, so several can exist side by side.
+// The ControllerList/RenderList storage is sized by EngineContext.
+class Engine{
+  public:
+#if BAND_RENDERING
+    Arduboy2Base arduboy; // Never touches sBuffer, so the linker drops it
+#else
+    Arduboy2 arduboy;
+#endif
+    byte framerate;
+    FixedController<> controller;
+    InputQueue inputQueue;
+    ControllerList* controllerList;
+    RenderList* renderList;
+    TweenPool tweens; // Ticked by the game, so it stops while paused
+    SnapshotStore snapshots;
+    Random random;
+    ParticlePool particles; // Ticked by the game, so it stops while paused
+    FixedScheduler<SCHEDULER_MAX_TASKS> scheduler; // Ticked by the game, so it stops while paused
+#if BAND_RENDERING
+    uint8_t band[WIDTH]; // The page being rendered
+#endif
+#if SERIAL_VIEWER
+    FrameMirror mirror;
+#endif
+
+#if BAND_RENDERING
+    // Send the band and clear it for the next page in the same pass. Each byte is cleared
+    // while it shifts out, and waiting for SPIF before moving on is the fence that keeps the
+    // next page from drawing into the band until its last byte has left.
+    void sendBand(){
+      for( byte x = 0; x < WIDTH; x++ ){
+#ifdef SPDR
+        SPDR = band[x];
+        band[x] = 0;
+        while( !(SPSR & _BV(SPIF)) ){}
+#else
+        Arduboy2Core::paint8Pixels(band[x]);
+        band[x] = 0;
+#endif
+      }
+    }
+#endif
+
+  protected:
+    Engine(ControllerList* inControllerList, RenderList* inRenderList, byte inFramerate)
+      : framerate(inFramerate), controllerList(inControllerList), renderList(inRenderList), particles(&arduboy, &random) {}
+};
+
+// Owns an Engine and a Game built on it. Game takes an Engine* and provides begin(), update(),
+// and the MAX_CONTROLS/MAX_RENDERABLES it needs from the lists.
+template <typename Game>
+class EngineContext : public Engine{
+  public:
+    FixedControllerList<Game::MAX_CONTROLS> fixedControllerList;
+    FixedRenderList<Game::MAX_RENDERABLES> fixedRenderList;
+    Game game;
+
+    EngineContext(byte inFramerate)
+      : Engine(&fixedControllerList, &fixedRenderList, inFramerate), fixedControllerList(&controller), game(this) {}
+
+    void setup(){
+#if BAND_RENDERING
+      // begin() would draw the boot logo through the framebuffer
+      arduboy.boot();
+      arduboy.systemButtons();
+      arduboy.audio.begin();
+      memset(band, 0, WIDTH); // sendBand leaves it clear after that
+#else
+      arduboy.begin();
+      arduboy.clear(); // display() clears it after that
+#endif
+      random.seed(arduboy.generateRandomSeed());
+      arduboy.setFrameRate(framerate);
+      inputQueue.begin();
+      snapshots.begin();
+#if SERIAL_VIEWER
+      mirror.begin();
+#endif
+
+      game.begin();
+    }
+
+    void loop(){
+
+      /////////////
+      // Arduboy //
+      /////////////
+      if (!(arduboy.nextFrame())) return;
+      arduboy.pollButtons();
+#if SERIAL_VIEWER
+      mirror.poll(inputQueue);
+#endif
+
+      ////////////////
+      // Controller //
+      ////////////////
+      controller.update(inputQueue);
+      controllerList->runControls();
+
+      ////////////
+      // Update //
+      ////////////
+      game.update();
+      snapshots.update();
+
+      ////////////
+      // Render //
+      ////////////
+#if RENDER_STATS
+      renderStats.beginFrame();
+#endif
+#if BAND_RENDERING
+      renderBands();
+#else
+      renderList->renderAll();
+#endif
+
+      ///////////
+      // Debug //
+      ///////////
+#if RENDER_STATS
+      if( arduboy.frameCount % RENDER_STATS_INTERVAL == 0 ){
+        renderStats.report(arduboy.frameCount);
+      }
+#endif
+#if !BAND_RENDERING
+      if( DEBUG ){
+        arduboy.setCursor(0, 0);
+        arduboy.print(controller.debugPrint());
+      }
+#endif
+
+      /////////////
+      // Arduboy //
+      /////////////
+#if !BAND_RENDERING
+#if SERIAL_VIEWER
+      for( byte page = 0; page < HEIGHT / 8; page++ ){
+        mirror.sendPage(page, arduboy.getBuffer() + page * WIDTH);
+      }
+#endif
+      arduboy.display(CLEAR_BUFFER); // Clears each byte while the next one is on the wire
+#endif
+#if SERIAL_VIEWER
+      mirror.endFrame(arduboy.frameCount);
+#endif
+    }
+
+#if BAND_RENDERING
+    // The display takes pages top to bottom, so each band is sent as soon as it is drawn
+    void renderBands(){
+      for( int8_t page = 0; page < HEIGHT / 8; page++ ){
+        RenderTarget target = {band, page, 1};
+        renderList->renderTo(target);
+#if SERIAL_VIEWER
+        mirror.sendPage(page, band);
+#endif
+        sendBand();
+      }
+    }
+#endif
+
+    REPORT_INSTANCE_RAM(controller);
+    REPORT_INSTANCE_RAM(fixedControllerList);
+    REPORT_INSTANCE_RAM(fixedRenderList);
+    REPORT_INSTANCE_RAM(tweens);
+    REPORT_INSTANCE_RAM(snapshots);
+    REPORT_INSTANCE_RAM(particles);
+    REPORT_INSTANCE_RAM(scheduler);
+#if SERIAL_VIEWER
+    REPORT_INSTANCE_RAM(mirror);
+#endif
+    REPORT_INSTANCE_RAM(game);
+};
+
+#endif
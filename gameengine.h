@@ -2,13 +2,21 @@
 #define GAME_ENGINE
 
 #include "controller.h"
+#include "canvas.h"
+#include "assets.h"
+
+#ifdef __AVR__
+#include <new.h>
+#else
+#include <new>
+#endif
 
 class Controllable {
 public:
     Controllable(ControllerList* inControllerList) : controllerList(inControllerList) {}
 
-    void addControl(byte inID, byte inControl, void (*inFunc)(void*), void* inArgs) {
-        controllerList->addControl(inID, inControl, inFunc, inArgs);
+    bool addControl(byte inID, byte inControl, void (*inFunc)(void*), void* inArgs) {
+        return controllerList->addControl(inID, inControl, inFunc, inArgs);
     }
 
     virtual void takeControl() = 0;
@@ -28,51 +36,150 @@ public:
 class Renderable {
 public:
     // Constructor
-    Renderable(Arduboy2* inArduboy) : arduboy(inArduboy) {}
-    // Virtual render method (to be overridden by derived classes)
-    virtual void render() = 0;
-    Arduboy2* arduboy; // Pointer to the Arduboy instance
+    Renderable(Arduboy2Base* inArduboy) : arduboy(inArduboy) {}
+    // Draw into the whole framebuffer
+    void render() {
+        renderTo(screenTarget(arduboy));
+    }
+    // Draw into a target, which may only be a band of the screen (to be overridden by derived classes)
+    virtual void renderTo(const RenderTarget& target) = 0;
+    // Pages this draws into, so band rendering can skip it for the others
+    virtual void getPageSpan(int8_t& first, int8_t& last) const {
+        first = 0;
+        last = HEIGHT / 8 - 1;
+    }
+    Arduboy2Base* arduboy; // Pointer to the Arduboy instance
 };
 
+// True when inRenderable draws into any of the target's pages
+inline bool touchesTarget(const Renderable& inRenderable, const RenderTarget& target) {
+    int8_t first;
+    int8_t last;
+    inRenderable.getPageSpan(first, last);
+    return last >= target.firstPage && first < target.firstPage + target.numPages;
+}
+
 class RenderList{
   public:
 
-    static const int MAX_RENDERABLES = 10; // Define a maximum number of renderables
-    Renderable* aRenderables[MAX_RENDERABLES];
+    Renderable** aRenderables; // Storage owned by FixedRenderList
+    int nMaxRenderables;
     int nNumRenderable = 0;
-    
-    void addRenderable(Renderable* inRenderable) {
-        if (nNumRenderable < MAX_RENDERABLES) {
-            aRenderables[nNumRenderable] = inRenderable;
-            nNumRenderable++;
+    bool bOverflow = false; // Set when an addRenderable did not fit
+
+    // Returns false, and sets bOverflow, when the list is full
+    bool addRenderable(Renderable* inRenderable) {
+        if (nNumRenderable >= nMaxRenderables) {
+            bOverflow = true;
+            return false;
         }
+        aRenderables[nNumRenderable] = inRenderable;
+        nNumRenderable++;
+        return true;
+    }
+
+    void clearRenderables() {
+        nNumRenderable = 0;
     }
 
     void renderAll() {
         for (int i = 0; i < nNumRenderable; i++) {
+            RENDER_STAT_SLOT(i);
             aRenderables[i]->render();
         }
     }
 
+    // Draw only the renderables that reach the target's pages
+    void renderTo(const RenderTarget& target) {
+        for (int i = 0; i < nNumRenderable; i++) {
+            if (touchesTarget(*aRenderables[i], target)) {
+                RENDER_STAT_SLOT(i);
+                aRenderables[i]->renderTo(target);
+            }
+        }
+    }
+
+  protected:
+    RenderList(Renderable** inRenderables, int inMaxRenderables)
+        : aRenderables(inRenderables), nMaxRenderables(inMaxRenderables) {}
+};
+
+// RenderList with room for MAX_RENDERABLES entries
+template <byte MAX_RENDERABLES>
+class FixedRenderList : public RenderList{
+  public:
+    static const byte CAPACITY = MAX_RENDERABLES;
+
+    FixedRenderList() : RenderList(renderables, MAX_RENDERABLES) {}
+
+  private:
+    Renderable* renderables[MAX_RENDERABLES];
+};
+
+// Build with REPORT_RAM defined to true to get one compiler warning per REPORT_INSTANCE_RAM,
+// showing the instance's size in bytes as the BYTES template argument
+#if defined(REPORT_RAM) && REPORT_RAM
+template <size_t BYTES>
+__attribute__((deprecated("RAM report, BYTES is the instance size"))) constexpr int ramReport() { return 0; }
+#define REPORT_INSTANCE_RAM(instance) enum { ramReport_##instance = ramReport<sizeof(instance)>() }
+#else
+#define REPORT_INSTANCE_RAM(instance) static_assert(true, "")
+#endif
+
+// Enter/tick/exit hooks for one state, called with the machine's owner
+typedef void (*StateFunction)(void*);
+struct StateHandlers {
+    StateFunction enter;
+    StateFunction tick;
+    StateFunction exit;
+};
+
+template <typename StateEnum>
+constexpr uint16_t stateBit(StateEnum state) {
+    return static_cast<uint16_t>(1u << static_cast<int>(state));
+}
+
+// Transition table for a StateEnum, as a bitmask of the states reachable from each state.
+// Specialize it per enum to restrict transitions; the default allows everything.
+template <typename StateEnum>
+struct StateTransitions {
+    static constexpr uint16_t allowed(StateEnum from) {
+        return 0xFFFF;
+    }
 };
 
+template <typename StateEnum>
+constexpr bool isTransitionAllowed(StateEnum from, StateEnum to) {
+    return (StateTransitions<StateEnum>::allowed(from) & stateBit(to)) != 0;
+}
 
 template <typename StateEnum>
 class StateMachine : public Controllable, public Updateable {
 public:
+    static const int STATE_COUNT = static_cast<int>(StateEnum::STATE_MAX) + 1;
+
     // Constructor
-    StateMachine(ControllerList* inControllerList, StateEnum initialState)
-        : Controllable(inControllerList), currentState(initialState), bTransitionFinished(true) {
+    // inHandlers is a PROGMEM table with one StateHandlers entry per state, or nullptr
+    StateMachine(ControllerList* inControllerList, StateEnum initialState, const StateHandlers* inHandlers = nullptr, void* inOwner = nullptr)
+        : Controllable(inControllerList), currentState(initialState), bTransitionFinished(true), handlers(inHandlers), owner(inOwner) {
         // Add controls to the ControllerList
         // addControl(BUTTON_JUST_PRESSED, UP_BUTTON, &StateMachine::previousStateWrapper, this);
         // addControl(BUTTON_JUST_PRESSED, DOWN_BUTTON, &StateMachine::nextStateWrapper, this);
     }
 
-    // Set the current state
+    // Set the current state, ignored if the table does not allow it from the current state
     void setState(StateEnum newState) {
-        if (isValidState(newState)) {
-            currentState = newState;
-            bTransitionFinished = false; // Transition started
+        if (isValidState(newState) && isTransitionAllowed(currentState, newState)) {
+            changeState(newState);
+        }
+    }
+
+    // Transition between two known states, rejected at compile time if the table does not allow it
+    template <StateEnum From, StateEnum To>
+    void transition() {
+        static_assert(isTransitionAllowed(From, To), "StateMachine: transition not in the table");
+        if (currentState == From) {
+            changeState(To);
         }
     }
 
@@ -87,8 +194,7 @@ public:
         if (nextStateValue > static_cast<int>(StateEnum::STATE_MAX)) {
             nextStateValue = static_cast<int>(StateEnum::STATE_MIN); // Wrap around to the first state
         }
-        currentState = static_cast<StateEnum>(nextStateValue);
-        bTransitionFinished = false; // Transition started
+        setState(static_cast<StateEnum>(nextStateValue));
     }
 
     // Transition to the previous state (cyclic)
@@ -97,8 +203,7 @@ public:
         if (prevStateValue < static_cast<int>(StateEnum::STATE_MIN)) {
             prevStateValue = static_cast<int>(StateEnum::STATE_MAX); // Wrap around to the last state
         }
-        currentState = static_cast<StateEnum>(prevStateValue);
-        bTransitionFinished = false; // Transition started
+        setState(static_cast<StateEnum>(prevStateValue));
     }
 
     // Check if the current state matches a specific state
@@ -116,6 +221,25 @@ public:
         bTransitionFinished = true;
     }
 
+    // Frames spent in the current state, counting the current frame
+    uint16_t getFramesInState() const {
+        return framesInState;
+    }
+
+    // Total frames spent in a state since startup (saturates), for profiling
+    uint16_t getStateFrames(StateEnum state) const {
+        return stateFrames[static_cast<int>(state)];
+    }
+
+    // Put the machine back into a saved state without running any handlers
+    void restoreState(StateEnum state, uint16_t inFramesInState) {
+        if (isValidState(state)) {
+            currentState = state;
+            framesInState = inFramesInState;
+            bTransitionFinished = true;
+        }
+    }
+
     // Static function to transition to the next state (for ControllerList)
     static void nextStateWrapper(void* data) {
         StateMachine* stateMachine = static_cast<StateMachine*>(data);
@@ -132,14 +256,55 @@ public:
 
     }
 
-    // Update the state machine
+    // Update the state machine, runs the tick handler of the current state
     void update() override {
-        // Add any update logic here
+        StateEnum tickedState = currentState;
+        int index = static_cast<int>(tickedState);
+        if (framesInState < 0xFFFF) {
+            framesInState++;
+        }
+        if (stateFrames[index] < 0xFFFF) {
+            stateFrames[index]++;
+        }
+
+        callHandler(tickedState, HANDLER_TICK);
+
+        // The transition is finished once the new state has run a full tick without leaving
+        if (currentState == tickedState) {
+            bTransitionFinished = true;
+        }
     }
 
 private:
     StateEnum currentState; // Current state of the state machine
     bool bTransitionFinished; // Flag to track if the transition is finished
+    const StateHandlers* handlers; // PROGMEM handler table, one entry per state
+    void* owner; // Passed to every handler
+    uint16_t framesInState = 0;
+    uint16_t stateFrames[STATE_COUNT] = {};
+
+    enum HandlerSlot { HANDLER_ENTER, HANDLER_TICK, HANDLER_EXIT };
+
+    void callHandler(StateEnum state, HandlerSlot slot) {
+        if (handlers == nullptr) {
+            return;
+        }
+        const StateHandlers* entry = &handlers[static_cast<int>(state)];
+        const StateFunction* field = slot == HANDLER_ENTER ? &entry->enter :
+                                     slot == HANDLER_TICK ? &entry->tick : &entry->exit;
+        StateFunction func = reinterpret_cast<StateFunction>(pgm_read_ptr(field));
+        if (func != nullptr) {
+            func(owner);
+        }
+    }
+
+    void changeState(StateEnum newState) {
+        callHandler(currentState, HANDLER_EXIT);
+        currentState = newState;
+        framesInState = 0;
+        bTransitionFinished = false; // Transition started
+        callHandler(currentState, HANDLER_ENTER);
+    }
 
     // Check if a state is valid (within bounds)
     bool isValidState(StateEnum state) const {
@@ -148,12 +313,102 @@ private:
     }
 };
 
+// A self-contained game or screen that the SceneManager constructs into its arena.
+// Scenes hold their storage inline rather than allocating it, so the arena accounts for all of it.
+class Scene : public Updateable {
+public:
+    virtual ~Scene() {}
+
+    // Register the scene's controls on its ControllerList
+    virtual void takeControl() = 0;
+
+    // Register the scene's renderables, in draw order
+    virtual void addRenderables(RenderList* inRenderList) = 0;
+
+    // Write/read the scene's runtime state for a snapshot, in matching order
+    virtual void save(BitWriter& /*writer*/) {}
+    virtual void restore(BitReader& /*reader*/) {}
+
+    // Checked by the owner after update to leave the scene
+    virtual bool isFinished() {
+        return false;
+    }
+
+    void update() override {}
+};
+
+// Holds at most one Scene at a time in a fixed arena, so peak RAM is the largest scene.
+// Scenes declare NUM_CONTROLS and NUM_RENDERABLES, checked against the list capacity set aside for scenes.
+template <size_t ARENA_SIZE, byte MAX_CONTROLS, byte MAX_RENDERABLES>
+class SceneManager {
+public:
+    SceneManager(ControllerList* inControllerList, RenderList* inRenderList)
+        : controllerList(inControllerList), renderList(inRenderList) {}
+
+    ~SceneManager() {
+        unload();
+    }
+
+    // Tear down the current scene and construct a new one in its place
+    template <typename SceneType, typename... Args>
+    SceneType* load(byte inSceneID, Args... args) {
+        static_assert(sizeof(SceneType) <= ARENA_SIZE, "SceneManager: scene does not fit in the arena");
+        static_assert(SceneType::NUM_CONTROLS <= MAX_CONTROLS, "SceneManager: scene has more controls than the ControllerList holds");
+        static_assert(SceneType::NUM_RENDERABLES <= MAX_RENDERABLES, "SceneManager: scene has more renderables than the RenderList holds");
+        unload();
+        SceneType* scene = new (arena) SceneType(args...);
+        currentScene = scene;
+        sceneID = inSceneID;
+        return scene;
+    }
+
+    void unload() {
+        controllerList->clearControls();
+        renderList->clearRenderables();
+        if (currentScene != nullptr) {
+            currentScene->~Scene();
+            currentScene = nullptr;
+        }
+        sceneID = 0;
+    }
+
+    // Point the ControllerList and RenderList at the current scene
+    void bind(bool withControls = true) {
+        controllerList->clearControls();
+        renderList->clearRenderables();
+        if (currentScene != nullptr) {
+            if (withControls) {
+                currentScene->takeControl();
+            }
+            currentScene->addRenderables(renderList);
+        }
+    }
+
+    Scene* getScene() const {
+        return currentScene;
+    }
+
+    byte getSceneID() const {
+        return sceneID;
+    }
+
+private:
+    alignas(alignof(void*)) byte arena[ARENA_SIZE];
+    Scene* currentScene = nullptr;
+    byte sceneID = 0; // 0 when no scene is loaded
+    ControllerList* controllerList;
+    RenderList* renderList;
+};
+
 class Animator : public Renderable, public Updateable {
   public:
     const unsigned char** sprite;
     int frames;
     int size;
 
+    const AssetPack* pack = nullptr; // When set, frames come from spriteID in the pack instead
+    byte spriteID = 0;
+
     int currentframe = 0;
     int framecounter;
     int framerate;
@@ -168,7 +423,7 @@ class Animator : public Renderable, public Updateable {
       posY = inY;
     }
 
-    Animator(Arduboy2* inArduboy, const unsigned char** inSprite, int inSize, int inFrames, int inFrameRate) : Renderable(inArduboy){
+    Animator(Arduboy2Base* inArduboy, const unsigned char** inSprite, int inSize, int inFrames, int inFrameRate) : Renderable(inArduboy){
       size = inSize;
       sprite = inSprite;
       framerate = inFrameRate;
@@ -182,6 +437,14 @@ class Animator : public Renderable, public Updateable {
       framecounter = 0;
     }
 
+    void setSprite(const AssetPack* inPack, byte inSpriteID) {
+      pack = inPack;
+      spriteID = inSpriteID;
+      frames = inPack -> getSprite(inSpriteID).frames;
+      currentframe = 0;
+      framecounter = 0;
+    }
+
     void startAnimation() {
       bAnimating = true;
       currentframe = 0;
@@ -207,8 +470,12 @@ class Animator : public Renderable, public Updateable {
       }
     }
 
-    void render() override {
-      arduboy -> drawBitmap(posX, posY, sprite[currentframe], size, size, WHITE);
+    void renderTo(const RenderTarget& target) override {
+      if( pack != nullptr ){
+        pack -> draw(target, posX, posY, spriteID, currentframe);
+        return;
+      }
+      drawBitmap(target, posX, posY, sprite[currentframe], size, size);
     }
 };
 
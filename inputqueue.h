@@ -0,0 +1,81 @@
+#ifndef INPUT_QUEUE
+#define INPUT_QUEUE
+
+// A button edge as seen by the sampler, stamped with millis() (low 16 bits)
+struct InputEvent {
+  byte buttons;
+  uint16_t stamp;
+};
+
+// Single-producer/single-consumer ring of button edges.
+// The producer is the timer interrupt (sample), the consumer is Controller::update (pop).
+// Each side only writes its own index and indexes are single bytes, so no locking is needed on AVR.
+class InputQueue{
+  public:
+    static const byte QUEUE_SIZE = 16; // Must be a power of two
+    InputEvent events[QUEUE_SIZE];
+    volatile byte head = 0; // Written by the producer only
+    volatile byte tail = 0; // Written by the consumer only
+    volatile byte lastSample = 0;
+    volatile byte dropped = 0;
+    volatile byte extraButtons = 0; // ORed into every sample, for buttons held somewhere else (FrameMirror)
+
+    // Called from interrupt context, only pushes when the buttons changed
+    void sample(byte inButtons){
+      if( inButtons == lastSample ){
+        return;
+      }
+      byte next = (head + 1) & (QUEUE_SIZE - 1);
+      if( next == tail ){
+        // Full, keep lastSample so the edge is retried on the next tick
+        if( dropped < 255 ){
+          dropped++;
+        }
+        return;
+      }
+      events[head].buttons = inButtons;
+      events[head].stamp = (uint16_t)millis();
+      asm volatile("" ::: "memory"); // Publish the event before the index
+      head = next;
+      lastSample = inButtons;
+    }
+
+    bool pop(InputEvent& outEvent){
+      byte currentTail = tail;
+      if( currentTail == head ){
+        return false;
+      }
+      asm volatile("" ::: "memory"); // Read the event after the index
+      outEvent = events[currentTail];
+      tail = (currentTail + 1) & (QUEUE_SIZE - 1);
+      return true;
+    }
+
+    bool isEmpty() const {
+      return head == tail;
+    }
+
+    // Hooks the sampler onto Timer0 compare B, which fires once per millis() tick (~1kHz)
+    // and leaves the Timer0 overflow used by millis() untouched
+    void begin();
+};
+
+InputQueue* inputQueueInstance = nullptr;
+
+#ifdef __AVR__
+ISR(TIMER0_COMPB_vect){
+  if( inputQueueInstance != nullptr ){
+    inputQueueInstance->sample(Arduboy2Core::buttonsState() | inputQueueInstance->extraButtons);
+  }
+}
+#endif
+
+inline void InputQueue::begin(){
+  inputQueueInstance = this;
+#ifdef __AVR__
+  OCR0B = 0x80;
+  TIMSK0 |= _BV(OCIE0B);
+#endif
+}
+
+#endif
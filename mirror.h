@@ -0,0 +1,78 @@
+#ifndef MIRROR
+#define MIRROR
+
+// Streams the screen over USB serial for tools/viewer.py and takes buttons back, so a run
+// can be watched and played from a terminal. There is no RAM for a copy of the last frame,
+// so chunks are compared by hash and only the changed ones are sent. One chunk a frame is
+// also sent regardless, so a hash collision only leaves it stale until its turn comes round.
+// The stream is:
+//   0xA5, chunk, 16 bytes   chunk = page * 8 + column / 16, bytes in framebuffer order
+//   0x5A, frame             end of frame (low byte of the frame count)
+// Each byte from the viewer is the held buttons in Arduboy2's bits. Bit 0 is never a
+// button, so a byte with it set asks for every chunk to be sent again.
+const byte MIRROR_CHUNK_WIDTH = 16;
+const byte MIRROR_CHUNKS_PER_PAGE = WIDTH / MIRROR_CHUNK_WIDTH;
+const byte MIRROR_NUM_CHUNKS = MIRROR_CHUNKS_PER_PAGE * HEIGHT / 8;
+const byte MIRROR_CHUNK_MARK = 0xA5;
+const byte MIRROR_FRAME_MARK = 0x5A;
+const byte MIRROR_RESYNC = 0x01;
+
+class FrameMirror{
+  public:
+    void begin(){
+      Serial.begin(9600); // USB CDC ignores the baud rate
+    }
+
+    // Forget what the viewer has, so the next frame is sent whole
+    void resync(){
+      bResync = true;
+    }
+
+    // Hand the viewer's latest buttons to the queue's sampler
+    void poll(InputQueue& inQueue){
+      while( Serial.available() > 0 ){
+        byte value = Serial.read();
+        if( value & MIRROR_RESYNC ){
+          resync();
+        }
+        inQueue.extraButtons = value & ~MIRROR_RESYNC;
+      }
+    }
+
+    // Send the chunks of one page that changed since they were last sent
+    void sendPage(byte inPage, const uint8_t* inColumns){
+      for( byte i = 0; i < MIRROR_CHUNKS_PER_PAGE; i++ ){
+        const uint8_t* data = inColumns + i * MIRROR_CHUNK_WIDTH;
+        byte chunk = inPage * MIRROR_CHUNKS_PER_PAGE + i;
+        uint16_t hash = chunkHash(data);
+        if( bResync || chunk == refreshChunk || hash != hashes[chunk] ){
+          hashes[chunk] = hash;
+          Serial.write(MIRROR_CHUNK_MARK);
+          Serial.write(chunk);
+          Serial.write(data, MIRROR_CHUNK_WIDTH);
+        }
+      }
+    }
+
+    void endFrame(byte inFrame){
+      Serial.write(MIRROR_FRAME_MARK);
+      Serial.write(inFrame);
+      bResync = false;
+      refreshChunk = (refreshChunk + 1) % MIRROR_NUM_CHUNKS;
+    }
+
+  private:
+    uint16_t hashes[MIRROR_NUM_CHUNKS]; // Of each chunk as last sent
+    bool bResync = true;
+    byte refreshChunk = 0;
+
+    static uint16_t chunkHash(const uint8_t* inData){
+      uint16_t hash = 0;
+      for( byte i = 0; i < MIRROR_CHUNK_WIDTH; i++ ){
+        hash = hash * 31 + inData[i];
+      }
+      return hash;
+    }
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef PARTICLES
+#define PARTICLES
+
+#include "gameengine.h"
+#include "random.h"
+
+#ifndef MAX_PARTICLES
+#define MAX_PARTICLES 32 // 7 bytes each
+#endif
+
+// Positions and velocities are in 1/16 pixel units
+const byte PARTICLE_SHIFT = 4;
+
+// Unit vectors for 16 directions, scaled by 16, as x/y pairs
+const int8_t particleDirections[32] PROGMEM = {
+  16, 0,   15, 6,   11, 11,   6, 15,   0, 16,   -6, 15,   -11, 11,   -15, 6,
+  -16, 0,  -15, -6, -11, -11, -6, -15, 0, -16,  6, -15,   11, -11,   15, -6
+};
+
+// Single pixel particles kept as parallel arrays. Live particles are packed at the front,
+// so update and render are one tight loop each with no per-particle objects.
+class ParticlePool : public Updateable, public Renderable {
+  public:
+    int16_t posX[MAX_PARTICLES];
+    int16_t posY[MAX_PARTICLES];
+    int8_t velX[MAX_PARTICLES];
+    int8_t velY[MAX_PARTICLES];
+    byte life[MAX_PARTICLES];
+    uint16_t numLive = 0;
+
+    int8_t gravity = 1; // Added to velY every frame
+    Random* random;
+
+    ParticlePool(Arduboy2Base* inArduboy, Random* inRandom) : Renderable(inArduboy), random(inRandom) {}
+
+    // Throw inCount particles out of a point in random directions.
+    // inSpeed is in 1/16 pixel per frame (max 127), inLife in frames. Extra particles are dropped when full.
+    void burst(int inX, int inY, byte inCount, byte inSpeed, byte inLife){
+      if( inSpeed > 127 ){
+        inSpeed = 127; // Keeps velocities within int8_t
+      }
+      for( byte i = 0; i < inCount && numLive < MAX_PARTICLES; i++ ){
+        byte direction = (random -> next() & 15) << 1;
+        byte speed = (inSpeed >> 1) + random -> nextBelow(inSpeed + 1) / 2;
+        posX[numLive] = inX << PARTICLE_SHIFT;
+        posY[numLive] = inY << PARTICLE_SHIFT;
+        velX[numLive] = ((int8_t)pgm_read_byte(&particleDirections[direction]) * speed) >> PARTICLE_SHIFT;
+        velY[numLive] = ((int8_t)pgm_read_byte(&particleDirections[direction + 1]) * speed) >> PARTICLE_SHIFT;
+        life[numLive] = inLife;
+        numLive++;
+      }
+    }
+
+    void clear(){
+      numLive = 0;
+    }
+
+    void update() override {
+      uint16_t i = 0;
+      while( i < numLive ){
+        int16_t x = posX[i] + velX[i];
+        int16_t y = posY[i] + velY[i];
+        if( --life[i] == 0 || x < 0 || x >= (WIDTH << PARTICLE_SHIFT) || y >= (HEIGHT << PARTICLE_SHIFT) ){
+          // Move the last live particle into this slot
+          numLive--;
+          posX[i] = posX[numLive];
+          posY[i] = posY[numLive];
+          velX[i] = velX[numLive];
+          velY[i] = velY[numLive];
+          life[i] = life[numLive];
+          continue;
+        }
+        posX[i] = x;
+        posY[i] = y;
+        if( velY[i] < 127 - gravity ){
+          velY[i] += gravity;
+        }
+        i++;
+      }
+    }
+
+    // Plot straight into the target
+    void renderTo(const RenderTarget& target) override {
+      RENDER_STAT_CALL();
+      for( uint16_t i = 0; i < numLive; i++ ){
+        int16_t y = posY[i] >> PARTICLE_SHIFT;
+        if( y < 0 || !target.hasPage(y >> 3) ){
+          continue;
+        }
+        byte x = posX[i] >> PARTICLE_SHIFT;
+        RENDER_STAT_WRITE(y >> 3, x, target.column(y >> 3, x), 1 << (y & 7));
+        target.column(y >> 3, x) |= 1 << (y & 7);
+      }
+    }
+};
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef PAYLINES
+#define PAYLINES
+
+// Cells of the reel window are bits of a mask, bit = reel * rows + row, so up to 16 cells
+#ifndef PAYLINE_MAX_SYMBOLS
+#define PAYLINE_MAX_SYMBOLS 8
+#endif
+
+const byte PAYLINE_NO_WILD = 0xFF;
+
+// Payline through a 3 row window, one row per reel for up to 5 reels
+constexpr uint16_t paylineMask3(byte row0, byte row1, byte row2, byte row3 = 0xFF, byte row4 = 0xFF){
+  return (1u << row0) | (1u << (3 + row1)) | (1u << (6 + row2)) |
+         (row3 != 0xFF ? 1u << (9 + row3) : 0) | (row4 != 0xFF ? 1u << (12 + row4) : 0);
+}
+
+struct LineWin {
+  byte line;
+  byte symbol;
+  byte count;       // Reels matched from the left
+  uint16_t cells;   // Window cells that make up the win
+  uint16_t payout;
+};
+
+// Scores a stopped window against every payline. The window is kept as one mask per symbol,
+// so a line of symbol s (with wilds standing in) is matched by one AND against the line mask.
+class PaylineEvaluator{
+  public:
+    byte numReels;
+    byte numRows;
+    const uint16_t* lines; // PROGMEM line masks
+    byte numLines;
+    const uint16_t* pays;  // PROGMEM, pays[symbol * numReels + count - 1], 0 when that count does not pay
+    byte wildSymbol = PAYLINE_NO_WILD;
+
+    PaylineEvaluator(byte inReels, byte inRows, const uint16_t* inLines, byte inNumLines, const uint16_t* inPays)
+      : numReels(inReels), numRows(inRows), lines(inLines), numLines(inNumLines), pays(inPays) {
+      clear();
+    }
+
+    void clear(){
+      for( byte symbol = 0; symbol < PAYLINE_MAX_SYMBOLS; symbol++ ){
+        symbolMasks[symbol] = 0;
+      }
+    }
+
+    // Symbols outside 0..PAYLINE_MAX_SYMBOLS-1 never match
+    void setCell(byte inReel, byte inRow, int inSymbol){
+      uint16_t bit = 1u << (inReel * numRows + inRow);
+      for( byte symbol = 0; symbol < PAYLINE_MAX_SYMBOLS; symbol++ ){
+        symbolMasks[symbol] &= ~bit;
+      }
+      if( inSymbol >= 0 && inSymbol < PAYLINE_MAX_SYMBOLS ){
+        symbolMasks[inSymbol] |= bit;
+      }
+    }
+
+    // Best paying left-aligned run on each line. Fills up to inMaxWins entries of outWins
+    // and returns how many lines paid.
+    byte evaluate(LineWin* outWins, byte inMaxWins) const {
+      uint16_t wild = wildSymbol < PAYLINE_MAX_SYMBOLS ? symbolMasks[wildSymbol] : 0;
+      byte numWins = 0;
+      for( byte line = 0; line < numLines && numWins < inMaxWins; line++ ){
+        uint16_t lineMask = pgm_read_word(&lines[line]);
+        LineWin best = {line, 0, 0, 0, 0};
+        for( byte symbol = 0; symbol < PAYLINE_MAX_SYMBOLS; symbol++ ){
+          uint16_t missing = lineMask & ~(symbolMasks[symbol] | wild);
+          // The run ends at the first reel whose line cell is missing
+          byte count = numReels;
+          for( byte reel = 0; reel < numReels; reel++ ){
+            if( missing & reelMask(reel) ){
+              count = reel;
+              break;
+            }
+          }
+          if( count == 0 ){
+            continue;
+          }
+          uint16_t payout = pgm_read_word(&pays[symbol * numReels + count - 1]);
+          if( payout > best.payout ){
+            best.symbol = symbol;
+            best.count = count;
+            best.cells = lineMask & prefixMask(count);
+            best.payout = payout;
+          }
+        }
+        if( best.payout > 0 ){
+          outWins[numWins++] = best;
+        }
+      }
+      return numWins;
+    }
+
+    static uint16_t totalPayout(const LineWin* inWins, byte inNumWins){
+      uint16_t total = 0;
+      for( byte i = 0; i < inNumWins; i++ ){
+        total += inWins[i].payout;
+      }
+      return total;
+    }
+
+  private:
+    uint16_t symbolMasks[PAYLINE_MAX_SYMBOLS];
+
+    uint16_t reelMask(byte inReel) const {
+      return ((1u << numRows) - 1) << (inReel * numRows);
+    }
+
+    // All cells of the first inReels reels
+    uint16_t prefixMask(byte inReels) const {
+      return inReels * numRows >= 16 ? 0xFFFF : (1u << (inReels * numRows)) - 1;
+    }
+};
+
+#endif
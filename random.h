@@ -0,0 +1,70 @@
+#ifndef RANDOM
+#define RANDOM
+
+// Jump polynomial for 2^24 xorshift32 steps, see Random::jump
+const uint32_t RANDOM_JUMP_POLY = 0x17EC2BC1;
+
+// Small per-instance PRNG (xorshift32) so game logic does not share libc rand() state.
+// The same seed always gives the same sequence, and jump() splits it into independent streams.
+class Random{
+  public:
+    uint32_t state;
+
+    Random(uint32_t inSeed = 1){
+      seed(inSeed);
+    }
+
+    void seed(uint32_t inSeed){
+      state = inSeed != 0 ? inSeed : 0x6D2B79F5; // xorshift must not start at zero
+    }
+
+    uint32_t next(){
+      uint32_t x = state;
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      state = x;
+      return x;
+    }
+
+    // 0..inBound-1 with no modulo bias. Multiplies the top 16 bits into the range and only
+    // re-draws (and divides) in the rare case the draw lands in the biased sliver.
+    // A bound of 0 stands for 65536, the whole 16 bit range, which is what nextRange asks
+    // for over all of int16_t.
+    uint16_t nextBelow(uint16_t inBound){
+      if( inBound == 0 ){
+        return next() >> 16;
+      }
+      uint32_t product = (uint32_t)(next() >> 16) * inBound;
+      uint16_t low = product;
+      if( low < inBound ){
+        uint16_t threshold = (uint16_t)(-inBound) % inBound;
+        while( low < threshold ){
+          product = (uint32_t)(next() >> 16) * inBound;
+          low = product;
+        }
+      }
+      return product >> 16;
+    }
+
+    // inMin..inMax inclusive
+    int16_t nextRange(int16_t inMin, int16_t inMax){
+      return inMin + nextBelow(inMax - inMin + 1);
+    }
+
+    // Advance 2^24 draws in 32 steps. xorshift is linear, so the state 2^24 steps ahead is
+    // the XOR of the next 32 states picked by the jump polynomial. Jumping k times from a
+    // shared seed gives stream k, which will not overlap the others for 16M draws.
+    void jump(){
+      uint32_t jumped = 0;
+      for( byte bit = 0; bit < 32; bit++ ){
+        if( RANDOM_JUMP_POLY & (1UL << bit) ){
+          jumped ^= state;
+        }
+        next();
+      }
+      state = jumped;
+    }
+};
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+// Build with RENDER_STATS true to measure what each Renderable in the RenderList costs.
+// The canvas drawing counts its draw calls, the framebuffer bytes it writes, and overdraw:
+// lit pixels drawn again. Totals are kept per RenderList slot, and overdraw is also kept
+// per 16x8 tile of the screen as a heatmap. Every RENDER_STATS_INTERVAL frames one frame's
+// numbers go out over Serial as
+//   render,frame,slot,calls,bytes,overdraw     one line per slot that drew anything
+//   heat,frame,t0,...,t63                      overdraw per tile, rows of 8 from the top
+// Nested drawing (a ReelBank's reels, a Reel's symbols) counts towards the top level slot.
+// With RENDER_STATS false the hooks compile to nothing.
+#ifndef RENDER_STATS
+#define RENDER_STATS false
+#endif
+
+#ifndef RENDER_STATS_INTERVAL
+#define RENDER_STATS_INTERVAL 60
+#endif
+
+#if RENDER_STATS
+
+const byte RENDER_STATS_SLOTS = 8; // Later slots are counted in the last one
+const byte RENDER_STATS_TILE_SHIFT = 4;
+const byte RENDER_STATS_TILE_COLUMNS = WIDTH >> RENDER_STATS_TILE_SHIFT;
+const byte RENDER_STATS_TILES = RENDER_STATS_TILE_COLUMNS * HEIGHT / 8;
+
+class RenderStats{
+  public:
+    struct Totals {
+      uint16_t calls;
+      uint16_t bytes;
+      uint16_t overdraw;
+    };
+
+    Totals slots[RENDER_STATS_SLOTS];
+    uint16_t heat[RENDER_STATS_TILES];
+    byte slot = 0; // Being drawn
+
+    void beginFrame(){
+      memset(slots, 0, sizeof(slots));
+      memset(heat, 0, sizeof(heat));
+      slot = 0;
+    }
+
+    void setSlot(byte inSlot){
+      slot = min(inSlot, (byte)(RENDER_STATS_SLOTS - 1));
+    }
+
+    void countCall(){
+      slots[slot].calls++;
+    }
+
+    // A framebuffer byte at inPage, inX that held inOld is drawn with inBits
+    void countWrite(int8_t inPage, int inX, uint8_t inOld, uint8_t inBits){
+      slots[slot].bytes++;
+      byte overdraw = countBits(inOld & inBits);
+      if( overdraw != 0 ){
+        slots[slot].overdraw += overdraw;
+        heat[inPage * RENDER_STATS_TILE_COLUMNS + (inX >> RENDER_STATS_TILE_SHIFT)] += overdraw;
+      }
+    }
+
+    void report(uint16_t inFrame){
+      for( byte i = 0; i < RENDER_STATS_SLOTS; i++ ){
+        if( slots[i].calls == 0 && slots[i].bytes == 0 ){
+          continue;
+        }
+        Serial.print(F("render,"));
+        Serial.print(inFrame);
+        Serial.print(',');
+        Serial.print(i);
+        Serial.print(',');
+        Serial.print(slots[i].calls);
+        Serial.print(',');
+        Serial.print(slots[i].bytes);
+        Serial.print(',');
+        Serial.println(slots[i].overdraw);
+      }
+      Serial.print(F("heat,"));
+      Serial.print(inFrame);
+      for( byte tile = 0; tile < RENDER_STATS_TILES; tile++ ){
+        Serial.print(',');
+        Serial.print(heat[tile]);
+      }
+      Serial.println();
+    }
+
+  private:
+    static byte countBits(uint8_t inBits){
+      byte count = 0;
+      for( ; inBits != 0; inBits &= inBits - 1 ){
+        count++;
+      }
+      return count;
+    }
+};
+
+RenderStats renderStats;
+
+#define RENDER_STAT_CALL() renderStats.countCall()
+#define RENDER_STAT_WRITE(page, x, old, bits) renderStats.countWrite(page, x, old, bits)
+#define RENDER_STAT_SLOT(slot) renderStats.setSlot(slot)
+
+#else
+
+#define RENDER_STAT_CALL()
+#define RENDER_STAT_WRITE(page, x, old, bits)
+#define RENDER_STAT_SLOT(slot)
+
+#endif
+
+#endif
@@ -0,0 +1,457 @@
+#ifndef SCENES
+#define SCENES
+
+#include "engine.h"
+#include "snake.h"
+#include "watermelon.h"
+#include "paylines.h"
+#include "watermelonpack.h"
+
+// Scene IDs for SceneManager::load, 0 means no scene
+enum SceneID {
+  SCENE_NONE,
+  SCENE_MENU,
+  SCENE_WATERMELON,
+  SCENE_SNAKE
+};
+
+// Menu entries, in display order
+const int GAME_COUNT = 2;
+const char* const gameNames[GAME_COUNT] = {
+  "WATERMELON",
+  "SNAKE"
+};
+
+class MenuScene : public Scene, public Renderable {
+  public:
+    static const byte NUM_CONTROLS = Menu::NUM_CONTROLS;
+    static const byte NUM_RENDERABLES = 1;
+
+    Menu menu;
+
+    MenuScene(Engine* inEngine)
+      : Renderable(&inEngine -> arduboy), menu(inEngine -> controllerList, &inEngine -> arduboy, GAME_COUNT) {}
+
+    void takeControl() override {
+      menu.takeControl();
+    }
+
+    void addRenderables(RenderList* inRenderList) override {
+      inRenderList -> addRenderable(this);
+    }
+
+    void renderTo(const RenderTarget& target) override {
+      for( int game = 0; game < GAME_COUNT; game++ ){
+        drawText(target, 16, 16 + game * 16, game == menu.getSelection() ? ">" : " ");
+        drawText(target, 16 + GLYPH_ADVANCE, 16 + game * 16, gameNames[game]);
+      }
+    }
+};
+
+const AssetPack watermelonAssets(watermelonPack);
+
+// Define the symbol IDs for each reel, indices into watermelonPack
+int reel1SymbolIDs[] = {0,1,2,3,4,5,6,7}; // Reel 1 has symbols in order 0, 1, 2, 3
+int reel2SymbolIDs[] = {7,6,5,4,3,2,1,1}; // Reel 2 has symbols in order 1, 2, 3, 0
+int reel3SymbolIDs[] = {2,3,0,1,7,5,4,6}; // Reel 3 has symbols in order 2, 3, 0, 1
+
+// Relative odds of each reel stopping at each position, shared by all three reels
+const byte WATERMELON_STOPS = 8;
+const uint16_t reelStopWeights[WATERMELON_STOPS] = {10, 10, 10, 10, 10, 10, 10, 4};
+
+// Rows across the 3x3 window: middle, top, bottom and the two diagonals
+const byte WATERMELON_LINES = 5;
+const uint16_t watermelonLines[WATERMELON_LINES] PROGMEM = {
+  paylineMask3(1, 1, 1),
+  paylineMask3(0, 0, 0),
+  paylineMask3(2, 2, 2),
+  paylineMask3(0, 1, 2),
+  paylineMask3(2, 1, 0)
+};
+
+// Pays for 1, 2 and 3 in a row by symbol ID. Symbol 7 is wild.
+const byte WATERMELON_WILD = 7;
+const uint16_t watermelonPays[8 * 3] PROGMEM = {
+  0, 0, 5,
+  0, 0, 5,
+  0, 0, 10,
+  0, 0, 10,
+  0, 0, 20,
+  0, 0, 20,
+  0, 2, 50,
+  0, 0, 100
+};
+
+const byte WATERMELON_REELS = 3;
+
+class WatermelonScene : public Scene {
+  public:
+    static const byte NUM_CONTROLS = ReelBank<WATERMELON_REELS>::NUM_CONTROLS;
+    static const byte NUM_RENDERABLES = 1;
+
+    ReelBank<WATERMELON_REELS> reels;
+
+    ParticlePool* particles;
+    bool bSpinning = false;
+    FixedAliasTable<WATERMELON_STOPS> stopTable;
+    PaylineEvaluator paylines;
+    LineWin wins[WATERMELON_LINES];
+    byte numWins = 0;
+
+    WatermelonScene(Engine* inEngine)
+      : reels(&inEngine -> arduboy, inEngine -> controllerList),
+        particles(&inEngine -> particles),
+        stopTable(reelStopWeights),
+        paylines(WATERMELON_REELS, 3, watermelonLines, WATERMELON_LINES, watermelonPays) {
+      Reel* reel1 = reels.addReel(&inEngine -> tweens, nullptr, reel1SymbolIDs, 8, 16, 3, 5, 10, 3, 120, 300);
+      Reel* reel2 = reels.addReel(&inEngine -> tweens, nullptr, reel2SymbolIDs, 8, 16, 3, 5, 10, 3, 180, 360);
+      Reel* reel3 = reels.addReel(&inEngine -> tweens, nullptr, reel3SymbolIDs, 8, 16, 3, 5, 10, 3, 240, 420);
+      reel1 -> setPosition(0, 24);
+      reel2 -> setPosition(64 - 8, 24);
+      reel3 -> setPosition(128 - 16, 24);
+
+      for( byte i = 0; i < WATERMELON_REELS; i++ ){
+        reels.getReel(i).setSpinDirection(-1);
+        reels.getReel(i).setStopTable(&stopTable, &inEngine -> random);
+        reels.getReel(i).setSymbolPack(&watermelonAssets);
+      }
+      paylines.wildSymbol = WATERMELON_WILD;
+
+      reel1 -> setDebugOutput(true);
+    }
+
+    void takeControl() override {
+      reels.takeControl();
+    }
+
+    void addRenderables(RenderList* inRenderList) override {
+      inRenderList -> addRenderable(&reels);
+    }
+
+    void update() override {
+      reels.update();
+
+      bool bWasSpinning = bSpinning;
+      bSpinning = !reels.isStopped();
+      if( bWasSpinning && !bSpinning && evaluateWins() > 0 ){
+        for( byte i = 0; i < WATERMELON_REELS; i++ ){
+          burstReel(reels.getReel(i));
+        }
+      }
+      else if( bSpinning ){
+        numWins = 0;
+      }
+    }
+
+    // Score the stopped window, returns the total payout
+    uint16_t evaluateWins(){
+      for( byte i = 0; i < WATERMELON_REELS; i++ ){
+        const Reel& reel = reels.getReel(i);
+        for( byte row = 0; row < 3; row++ ){
+          paylines.setCell(i, row, reel.getVisibleSymbolID(row));
+        }
+      }
+      numWins = paylines.evaluate(wins, WATERMELON_LINES);
+      return PaylineEvaluator::totalPayout(wins, numWins);
+    }
+
+    void burstReel(const Reel& inReel){
+      int half = inReel.getSymbolSize() / 2;
+      particles -> burst(inReel.getPosX() + half, inReel.getPosY() + half, MAX_PARTICLES / WATERMELON_REELS, 40, 30); // An even share of the pool, so every reel bursts
+    }
+
+    void save(BitWriter& writer) override {
+      reels.save(writer);
+    }
+
+    void restore(BitReader& reader) override {
+      reels.restore(reader);
+    }
+};
+
+class SnakeScene : public Scene {
+  public:
+    static const byte NUM_CONTROLS = Snake::NUM_CONTROLS;
+    static const byte NUM_RENDERABLES = 1;
+
+    Snake snake;
+    Scheduler* scheduler;
+    byte stepTask;
+
+    SnakeScene(Engine* inEngine)
+      : snake(inEngine -> controllerList, &inEngine -> arduboy, &inEngine -> random), scheduler(&inEngine -> scheduler) {
+      snake.setParticles(&inEngine -> particles);
+      stepTask = scheduler -> add(&Snake::STEP, &snake, snake.updatedelay + 1);
+    }
+
+    ~SnakeScene() {
+      scheduler -> remove(stepTask);
+    }
+
+    void takeControl() override {
+      snake.takeControl();
+    }
+
+    void addRenderables(RenderList* inRenderList) override {
+      inRenderList -> addRenderable(&snake);
+    }
+
+    // The snake moves from the scheduler, unless there was no room for its task
+    void update() override {
+      if( stepTask == NO_TASK ){
+        snake.update();
+      }
+    }
+
+    void save(BitWriter& writer) override {
+      if( stepTask != NO_TASK ){
+        snake.framecounter = snake.updatedelay + 1 - scheduler -> framesUntil(stepTask);
+      }
+      snake.save(writer);
+    }
+
+    void restore(BitReader& reader) override {
+      snake.restore(reader);
+      int delay = snake.updatedelay + 1 - snake.framecounter;
+      scheduler -> wake(stepTask, delay > 0 ? delay : 1);
+    }
+
+    bool isFinished() override {
+      return snake.bGameOver;
+    }
+};
+
+constexpr size_t maxOf(size_t a, size_t b) {
+  return a > b ? a : b;
+}
+
+// Sized for the largest scene
+const size_t SCENE_ARENA_SIZE = maxOf(sizeof(MenuScene), maxOf(sizeof(WatermelonScene), sizeof(SnakeScene)));
+const byte SCENE_MAX_CONTROLS = maxOf(MenuScene::NUM_CONTROLS, maxOf(WatermelonScene::NUM_CONTROLS, SnakeScene::NUM_CONTROLS));
+const byte SCENE_MAX_RENDERABLES = maxOf(MenuScene::NUM_RENDERABLES, maxOf(WatermelonScene::NUM_RENDERABLES, SnakeScene::NUM_RENDERABLES));
+
+// Game flow transitions
+template <>
+struct StateTransitions<GameStates> {
+  static constexpr uint16_t allowed(GameStates from) {
+    return from == GameStates::GAME_MENU  ? stateBit(GameStates::GAME_PLAY) | stateBit(GameStates::GAME_PAUSE) : // Pause when resuming a snapshot
+           from == GameStates::GAME_PLAY  ? stateBit(GameStates::GAME_PAUSE) | stateBit(GameStates::GAME_OVER) :
+           from == GameStates::GAME_PAUSE ? stateBit(GameStates::GAME_PLAY) | stateBit(GameStates::GAME_MENU) :
+           from == GameStates::GAME_OVER  ? stateBit(GameStates::GAME_MENU) : 0;
+  }
+};
+
+// Switches scenes as the GameStates machine moves between menu, play, pause and game over.
+// Control callbacks only request a state, it is applied on the next update so the
+// ControllerList is never rebound while it is running.
+class GameFlow : public Controllable, public Updateable, public Renderable {
+  public:
+    static const byte NUM_CONTROLS = 2;    // Most added by takeControl in any state
+    static const byte NUM_RENDERABLES = 2; // Particles and the overlay
+    static const byte MAX_CONTROLS = SCENE_MAX_CONTROLS + NUM_CONTROLS;
+    static const byte MAX_RENDERABLES = SCENE_MAX_RENDERABLES + NUM_RENDERABLES;
+
+    GameFlow(Engine* inEngine)
+      : Controllable(inEngine -> controllerList), Renderable(&inEngine -> arduboy), engine(inEngine),
+        renderList(inEngine -> renderList), snapshots(&inEngine -> snapshots), particles(&inEngine -> particles),
+        stateMachine(inEngine -> controllerList, GameStates::GAME_MENU, stateHandlers, this),
+        scenes(inEngine -> controllerList, inEngine -> renderList) {}
+
+    // Enter the initial menu state, then resume the saved session paused if there is one
+    void begin(){
+      byte data[SnapshotStore::DATA_SIZE];
+      byte length = snapshots -> load(data);
+      if( length > 0 && restoreSnapshot(data, length) ){
+        bResuming = true; // The slot already holds this state, so pausing does not save it again
+        stateMachine.transition<GameStates::GAME_MENU, GameStates::GAME_PAUSE>();
+        bResuming = false;
+      }
+      else{
+        onMenuEnter(this);
+      }
+    }
+
+    void requestState(GameStates inState){
+      pendingState = inState;
+      bPending = true;
+    }
+
+    GameStates getState() const {
+      return stateMachine.getState();
+    }
+
+    void update() override {
+      if( bPending ){
+        bPending = false;
+        stateMachine.setState(pendingState);
+      }
+      stateMachine.update();
+    }
+
+    void renderTo(const RenderTarget& target) override {
+      drawText(target, 40, 0, stateMachine.isState(GameStates::GAME_OVER) ? "GAME OVER" : "PAUSED");
+    }
+
+    // Only the status line on the top page
+    void getPageSpan(int8_t& first, int8_t& last) const override {
+      first = 0;
+      last = 0;
+    }
+
+    void takeControl() override {
+      switch( stateMachine.getState() ){
+        case GameStates::GAME_MENU:
+          addControl(BUTTON_JUST_PRESSED, A_BUTTON, &GameFlow::PLAY_PRESSED, this);
+          break;
+        case GameStates::GAME_PLAY:
+          addControl(BUTTON_HELD, A_BUTTON | B_BUTTON, &GameFlow::PAUSE_PRESSED, this);
+          break;
+        case GameStates::GAME_PAUSE:
+          addControl(BUTTON_JUST_PRESSED, A_BUTTON, &GameFlow::PLAY_PRESSED, this);
+          addControl(BUTTON_JUST_PRESSED, B_BUTTON, &GameFlow::MENU_PRESSED, this);
+          break;
+        case GameStates::GAME_OVER:
+          addControl(BUTTON_JUST_PRESSED, A_BUTTON, &GameFlow::MENU_PRESSED, this);
+          break;
+      }
+    }
+
+    //////////////
+    // CONTROLS //
+    //////////////
+    static void PLAY_PRESSED(void* data){
+      GameFlow* flow = static_cast<GameFlow*>(data);
+      flow -> requestState(GameStates::GAME_PLAY);
+    }
+    static void PAUSE_PRESSED(void* data){
+      GameFlow* flow = static_cast<GameFlow*>(data);
+      flow -> requestState(GameStates::GAME_PAUSE);
+    }
+    static void MENU_PRESSED(void* data){
+      GameFlow* flow = static_cast<GameFlow*>(data);
+      flow -> requestState(GameStates::GAME_MENU);
+    }
+
+    /////////////////
+    // Game States //
+    /////////////////
+    static void onMenuEnter(void* data){
+      GameFlow* flow = static_cast<GameFlow*>(data);
+      flow -> snapshots -> clear();
+      flow -> scenes.load<MenuScene>(SCENE_MENU, flow -> engine);
+      flow -> bindScene(true, false);
+    }
+
+    static void onMenuExit(void* data){
+      GameFlow* flow = static_cast<GameFlow*>(data);
+      // A resumed snapshot leaves the menu with the game already loaded
+      if( flow -> scenes.getSceneID() == SCENE_MENU ){
+        MenuScene* menuScene = static_cast<MenuScene*>(flow -> scenes.getScene());
+        flow -> selectedGame = menuScene -> menu.getSelection();
+      }
+    }
+
+    static void onPlayEnter(void* data){
+      GameFlow* flow = static_cast<GameFlow*>(data);
+      flow -> loadSelectedGame();
+      flow -> bindScene(true, false);
+    }
+
+    static void onPlayTick(void* data){
+      GameFlow* flow = static_cast<GameFlow*>(data);
+      Scene* scene = flow -> scenes.getScene();
+      flow -> engine -> tweens.update();
+      scene -> update();
+      flow -> particles -> update();
+      flow -> engine -> scheduler.update();
+      if( scene -> isFinished() ){
+        flow -> stateMachine.transition<GameStates::GAME_PLAY, GameStates::GAME_OVER>();
+      }
+    }
+
+    static void onPauseEnter(void* data){
+      GameFlow* flow = static_cast<GameFlow*>(data);
+      flow -> bindScene(false, true);
+      if( !flow -> bResuming ){
+        flow -> saveSnapshot();
+      }
+    }
+
+    static void onOverEnter(void* data){
+      GameFlow* flow = static_cast<GameFlow*>(data);
+      flow -> bindScene(false, true);
+    }
+
+  private:
+    Engine* engine;
+    RenderList* renderList;
+    SnapshotStore* snapshots;
+    ParticlePool* particles;
+    StateMachine<GameStates> stateMachine;
+    SceneManager<SCENE_ARENA_SIZE, SCENE_MAX_CONTROLS, SCENE_MAX_RENDERABLES> scenes;
+    GameStates pendingState = GameStates::GAME_MENU;
+    bool bPending = false;
+    bool bResuming = false; // Entering pause from a restored snapshot
+    int selectedGame = 0;
+
+    static const StateHandlers stateHandlers[];
+
+    // Load the game picked in the menu, coming back from pause keeps the loaded game
+    void loadSelectedGame(){
+      byte sceneID = selectedGame == 0 ? SCENE_WATERMELON : SCENE_SNAKE;
+      if( scenes.getSceneID() != sceneID ){
+        particles -> clear();
+        if( sceneID == SCENE_WATERMELON ){
+          scenes.load<WatermelonScene>(sceneID, engine);
+        }
+        else{
+          scenes.load<SnakeScene>(sceneID, engine);
+        }
+      }
+    }
+
+    // Snapshot layout: selected game, controller, then the scene's own save()
+    void saveSnapshot(){
+      byte data[SnapshotStore::DATA_SIZE];
+      BitWriter writer(data, sizeof(data));
+      writer.write(selectedGame, 4);
+      controllerList -> controller -> save(writer);
+      scenes.getScene() -> save(writer);
+      if( !writer.bOverflow ){
+        snapshots -> save(data, writer.length());
+      }
+    }
+
+    bool restoreSnapshot(const byte* inData, byte inLength){
+      BitReader reader(inData, inLength);
+      selectedGame = reader.read(4);
+      if( selectedGame >= GAME_COUNT ){
+        selectedGame = 0;
+        return false;
+      }
+      loadSelectedGame();
+      controllerList -> controller -> restore(reader);
+      scenes.getScene() -> restore(reader);
+      return !reader.bOverflow;
+    }
+
+    // Rebind the lists to the current scene, then add the flow's own controls and overlay
+    void bindScene(bool withSceneControls, bool withOverlay){
+      scenes.bind(withSceneControls);
+      renderList -> addRenderable(particles);
+      takeControl();
+      if( withOverlay ){
+        renderList -> addRenderable(this);
+      }
+    }
+};
+
+// Indexed by GameStates, kept in flash
+const StateHandlers GameFlow::stateHandlers[] PROGMEM = {
+  { &GameFlow::onMenuEnter,    nullptr,                &GameFlow::onMenuExit }, // GAME_MENU
+  { &GameFlow::onPlayEnter,    &GameFlow::onPlayTick,  nullptr },               // GAME_PLAY
+  { &GameFlow::onPauseEnter,   nullptr,                nullptr },               // GAME_PAUSE
+  { &GameFlow::onOverEnter,    nullptr,                nullptr }                // GAME_OVER
+};
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef SCHEDULER
+#define SCHEDULER
+
+#ifndef SCHEDULER_WHEEL_SLOTS
+#define SCHEDULER_WHEEL_SLOTS 16 // Power of two
+#endif
+
+#ifndef SCHEDULER_MAX_TASKS
+#define SCHEDULER_MAX_TASKS 8
+#endif
+
+const byte NO_TASK = 0xFF;
+
+// Runs callbacks on the frame they are due instead of every component counting frames itself.
+// Tasks sit in a timing wheel slot picked by their due frame, so each update only walks the
+// one slot for this frame and sleeping tasks cost nothing. A task's callback returns the
+// frames until it should run again, or 0 to sleep until woken.
+class Scheduler{
+  public:
+    typedef uint16_t (*TaskFunction)(void*);
+    struct Task {
+      TaskFunction func; // nullptr when the entry is free
+      void* args;
+      uint16_t due;      // Frame it runs on
+      byte next;         // Next task in the same slot
+      bool bQueued;
+    };
+
+    Task* tasks; // Storage owned by FixedScheduler
+    byte maxTasks;
+    uint16_t frame = 0;
+    bool bOverflow = false; // Set when an add did not fit
+
+    // Returns the task handle, or NO_TASK (setting bOverflow) when full.
+    // A delay of 0 adds the task asleep.
+    byte add(TaskFunction inFunc, void* inArgs, uint16_t inDelay){
+      for( byte task = 0; task < maxTasks; task++ ){
+        if( tasks[task].func == nullptr ){
+          tasks[task].func = inFunc;
+          tasks[task].args = inArgs;
+          tasks[task].bQueued = false;
+          if( inDelay > 0 ){
+            insert(task, inDelay);
+          }
+          return task;
+        }
+      }
+      bOverflow = true;
+      return NO_TASK;
+    }
+
+    void remove(byte inTask){
+      if( inTask < maxTasks ){
+        sleep(inTask);
+        tasks[inTask].func = nullptr;
+      }
+    }
+
+    // Run inDelay frames from now (at least 1), replacing any earlier wake up
+    void wake(byte inTask, uint16_t inDelay){
+      if( inTask < maxTasks && tasks[inTask].func != nullptr ){
+        sleep(inTask);
+        insert(inTask, inDelay > 0 ? inDelay : 1);
+      }
+    }
+
+    void sleep(byte inTask){
+      if( inTask >= maxTasks || !tasks[inTask].bQueued ){
+        return;
+      }
+      byte* link = &heads[tasks[inTask].due & (SCHEDULER_WHEEL_SLOTS - 1)];
+      while( *link != inTask ){
+        link = &tasks[*link].next;
+      }
+      *link = tasks[inTask].next;
+      tasks[inTask].bQueued = false;
+    }
+
+    // Frames until the task runs, 0 when it is asleep
+    uint16_t framesUntil(byte inTask) const {
+      if( inTask >= maxTasks || !tasks[inTask].bQueued ){
+        return 0;
+      }
+      return tasks[inTask].due - frame;
+    }
+
+    void clear(){
+      for( byte task = 0; task < maxTasks; task++ ){
+        tasks[task].func = nullptr;
+        tasks[task].bQueued = false;
+      }
+      for( byte slot = 0; slot < SCHEDULER_WHEEL_SLOTS; slot++ ){
+        heads[slot] = NO_TASK;
+      }
+    }
+
+    // Advance one frame and run what is due. Callbacks may only reschedule themselves, by
+    // their return value; adding or removing tasks from inside one is not supported.
+    void update(){
+      frame++;
+      byte slot = frame & (SCHEDULER_WHEEL_SLOTS - 1);
+      byte task = heads[slot];
+      heads[slot] = NO_TASK;
+      while( task != NO_TASK ){
+        Task& entry = tasks[task];
+        byte next = entry.next;
+        entry.bQueued = false;
+        if( entry.due == frame ){
+          uint16_t delay = entry.func(entry.args);
+          if( delay > 0 ){
+            insert(task, delay);
+          }
+        }
+        else{
+          insert(task, entry.due - frame); // Due on a later turn of the wheel
+        }
+        task = next;
+      }
+    }
+
+  protected:
+    Scheduler(Task* inTasks, byte inMaxTasks) : tasks(inTasks), maxTasks(inMaxTasks) {
+      clear();
+    }
+
+  private:
+    byte heads[SCHEDULER_WHEEL_SLOTS];
+
+    void insert(byte inTask, uint16_t inDelay){
+      Task& entry = tasks[inTask];
+      entry.due = frame + inDelay;
+      byte slot = entry.due & (SCHEDULER_WHEEL_SLOTS - 1);
+      entry.next = heads[slot];
+      heads[slot] = inTask;
+      entry.bQueued = true;
+    }
+};
+
+template <byte MAX_TASKS>
+class FixedScheduler : public Scheduler{
+  public:
+    static const byte CAPACITY = MAX_TASKS;
+
+    FixedScheduler() : Scheduler(entries, MAX_TASKS){}
+
+  private:
+    Task entries[MAX_TASKS];
+};
+
+#endif
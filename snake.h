@@ -3,24 +3,27 @@
 
 // Structure to hold a position (x, y)
 struct Position {
-    int x;
-    int y;
+    int8_t x;
+    int8_t y;
 };
 
+const int SNAKE_MAX_LENGTH = 100; // Segments a trail has room for
+const byte SNAKE_BOARD_SIZE = 10; // Tiles along each side of the board
+
+// The trail also keeps a count of its segments on each tile of the board, so checking a
+// tile does not walk every segment
 class SnakeTrail {
 public:
     // Constructor
-    SnakeTrail(int maxLength) : maxLength(maxLength), currentLength(0) {
-        trail = new Position[maxLength]; // Dynamically allocate the array
-    }
-
-    // Destructor
-    ~SnakeTrail() {
-        delete[] trail; // Free the allocated memory
-    }
+    SnakeTrail(int maxLength = SNAKE_MAX_LENGTH) : trail(), maxLength(min(maxLength, SNAKE_MAX_LENGTH)), currentLength(0) {}
 
     // Add a new position to the head of the trail
     void pushHead(int x, int y) {
+        if (currentLength > 0) {
+            occupancy.remove(trail[currentLength - 1].x, trail[currentLength - 1].y);
+            occupancy.add(x, y);
+        }
+
         // Shift all positions down the array
         for (int i = currentLength - 1; i > 0; i--) {
             trail[i] = trail[i - 1];
@@ -33,6 +36,7 @@ public:
 
     void increaseLength(){
     	currentLength++;
+        occupancy.add(trail[currentLength - 1].x, trail[currentLength - 1].y);
     }
 
     // Get the position at a specific index
@@ -51,33 +55,85 @@ public:
     }
 
     bool trailExists(int x, int y){
-    	for( int trailIndex = 0; trailIndex < currentLength; trailIndex++ ){
-    		if( trail[trailIndex].x == x && trail[trailIndex].y == y ){
-    			return true;
-    		}
-    	}
-    	return false;
+        return occupancy.count(x, y) > 0;
     }
 
+    // The head shares its tile with another segment
     bool checkGameOver(){
+        return currentLength > 0 && occupancy.count(trail[0].x, trail[0].y) > 1;
+    }
+
+    // Head as an absolute position, then one 3 bit step code per segment
+    void save(BitWriter& writer, byte coordBits){
+        writer.write(currentLength, 8);
+        if( currentLength == 0 ){
+            return;
+        }
+        writer.write(trail[0].x, coordBits);
+        writer.write(trail[0].y, coordBits);
+        for( int trailIndex = 1; trailIndex < currentLength; trailIndex++ ){
+            int dx = trail[trailIndex].x - trail[trailIndex - 1].x;
+            int dy = trail[trailIndex].y - trail[trailIndex - 1].y;
+            byte step = dx == 0 && dy == 0  ? TRAIL_SAME :
+                        dx == 0 && dy == -1 ? TRAIL_UP :
+                        dx == 0 && dy == 1  ? TRAIL_DOWN :
+                        dx == -1 && dy == 0 ? TRAIL_LEFT :
+                        dx == 1 && dy == 0  ? TRAIL_RIGHT : TRAIL_ABSOLUTE;
+            writer.write(step, 3);
+            if( step == TRAIL_ABSOLUTE ){
+                writer.write(trail[trailIndex].x, coordBits);
+                writer.write(trail[trailIndex].y, coordBits);
+            }
+        }
+    }
+
+    void restore(BitReader& reader, byte coordBits){
+        currentLength = min((int)reader.read(8), maxLength);
+        if( currentLength == 0 ){
+            recount();
+            return;
+        }
+        trail[0].x = reader.read(coordBits);
+        trail[0].y = reader.read(coordBits);
         for( int trailIndex = 1; trailIndex < currentLength; trailIndex++ ){
-            if( trail[0].x == trail[trailIndex].x && trail[0].y == trail[trailIndex].y ){
-                return true;
+            Position position = trail[trailIndex - 1];
+            switch( reader.read(3) ){
+                case TRAIL_UP:    position.y--; break;
+                case TRAIL_DOWN:  position.y++; break;
+                case TRAIL_LEFT:  position.x--; break;
+                case TRAIL_RIGHT: position.x++; break;
+                case TRAIL_ABSOLUTE:
+                    position.x = reader.read(coordBits);
+                    position.y = reader.read(coordBits);
+                    break;
             }
+            trail[trailIndex] = position;
         }
-        return false;
+        recount();
     }
 
 private:
-    Position* trail; // Array to hold the trail positions
+    enum TrailStep { TRAIL_SAME, TRAIL_UP, TRAIL_DOWN, TRAIL_LEFT, TRAIL_RIGHT, TRAIL_ABSOLUTE };
+
+    Position trail[SNAKE_MAX_LENGTH]; // Head first, zeroed
     int maxLength;   // Maximum length of the trail
     int currentLength; // Current length of the trail
+    FixedTileOccupancy<SNAKE_BOARD_SIZE, SNAKE_BOARD_SIZE> occupancy; // Segments per tile
+
+    void recount(){
+        occupancy.clear();
+        for( int trailIndex = 0; trailIndex < currentLength; trailIndex++ ){
+            occupancy.add(trail[trailIndex].x, trail[trailIndex].y);
+        }
+    }
 };
 
 class Snake : public Controllable, public Updateable, public Renderable {
 public:
+    static const byte NUM_CONTROLS = 4; // Added by takeControl
+
 	//Number of spots on the Grid
-    int gridsize = 10;
+    int gridsize = SNAKE_BOARD_SIZE;
     //Size of a Block on the Grid
     int blocksize = 6;
     //Position where to draw Grid
@@ -97,33 +153,35 @@ public:
     bool hasEaten = false;
     bool bGameOver = false;
 
-    SnakeTrail* trail;
+    SnakeTrail trail;
+    ParticlePool* particles = nullptr; // Optional, sparks when food is eaten
+    Random* random;
 
     // Constructor
-    Snake(ControllerList* inControllerList, Arduboy2* arduboy)
-        : Controllable(inControllerList), Renderable(arduboy) {
-        // Add controls to the ControllerList
-        trail = new SnakeTrail(100);
-
-        trail -> pushHead(0,0);
-        trail -> pushHead(0,0);
-        trail -> pushHead(0,0);
+    Snake(ControllerList* inControllerList, Arduboy2Base* arduboy, Random* inRandom)
+        : Controllable(inControllerList), Renderable(arduboy), random(inRandom) {
+        trail.pushHead(0,0);
+        trail.pushHead(0,0);
+        trail.pushHead(0,0);
 
-        trail -> increaseLength();
-        trail -> increaseLength();
-        trail -> increaseLength();
+        trail.increaseLength();
+        trail.increaseLength();
+        trail.increaseLength();
 
         setRandomFood();
     }
 
     void takeControl() override{
-      clearControls();
       addControl(BUTTON_JUST_PRESSED, UP_BUTTON, &Snake::UP_PRESSED, this);
       addControl(BUTTON_JUST_PRESSED, DOWN_BUTTON, &Snake::DOWN_PRESSED, this);
       addControl(BUTTON_JUST_PRESSED, LEFT_BUTTON, &Snake::LEFT_PRESSED, this);
       addControl(BUTTON_JUST_PRESSED, RIGHT_BUTTON, &Snake::RIGHT_PRESSED, this);
     }
 
+    void setParticles(ParticlePool* inParticles) {
+        particles = inParticles;
+    }
+
     // Set the position of the snake
     void setPosition(int inX, int inY) {
         screenPosX = inX;
@@ -131,14 +189,45 @@ public:
     }
 
     void setRandomFood(){
-    	foodX = rand() % gridsize;
-    	foodY = rand() % gridsize;
-    	while( trail -> trailExists(foodX, foodY) ){
-	    	foodX = rand() % gridsize;
-	    	foodY = rand() % gridsize;
+    	foodX = random -> nextBelow(gridsize);
+    	foodY = random -> nextBelow(gridsize);
+    	while( trail.trailExists(foodX, foodY) ){
+	    	foodX = random -> nextBelow(gridsize);
+	    	foodY = random -> nextBelow(gridsize);
     	}
     }
 
+    void save(BitWriter& writer){
+        byte coordBits = bitsFor(gridsize - 1);
+        writer.write(curX, coordBits);
+        writer.write(curY, coordBits);
+        writer.write(foodX, coordBits);
+        writer.write(foodY, coordBits);
+        writer.writeDelta(framecounter, 0, 8);
+        writer.writeDelta(updatedelay, 20, 8);
+        writer.write(direction == UP_BUTTON ? 0 : direction == DOWN_BUTTON ? 1 : direction == LEFT_BUTTON ? 2 : 3, 2);
+        writer.writeBool(justAte);
+        writer.writeBool(hasEaten);
+        writer.writeBool(bGameOver);
+        trail.save(writer, coordBits);
+    }
+
+    void restore(BitReader& reader){
+        byte coordBits = bitsFor(gridsize - 1);
+        curX = reader.read(coordBits);
+        curY = reader.read(coordBits);
+        foodX = reader.read(coordBits);
+        foodY = reader.read(coordBits);
+        framecounter = reader.readDelta(0, 8);
+        updatedelay = reader.readDelta(20, 8);
+        static const int directions[] = {UP_BUTTON, DOWN_BUTTON, LEFT_BUTTON, RIGHT_BUTTON};
+        direction = directions[reader.read(2)];
+        justAte = reader.readBool();
+        hasEaten = reader.readBool();
+        bGameOver = reader.readBool();
+        trail.restore(reader, coordBits);
+    }
+
     // Static function to decrement X selection
     static void UP_PRESSED(void* data) {
         Snake* snake = static_cast<Snake*>(data);
@@ -166,118 +255,141 @@ public:
     }
 
     // Render the snake
-    void render() override {
+    void renderTo(const RenderTarget& target) override {
         // arduboy->setCursor(screenPosX + (gridsize * blocksize) + 4, 0);
         // arduboy->print(curX);
         // arduboy->setCursor(screenPosX + (gridsize * blocksize) + 4, 16);
         // arduboy->print(curY);
 
-        for (int y = 0; y < gridsize; y++) {
-            for (int x = 0; x < gridsize; x++) {
-                arduboy->drawRect(screenPosX + (x * blocksize), screenPosY + (y * blocksize), blocksize, blocksize, WHITE);
-            }
-        }
+        drawCellGrid(target, screenPosX, screenPosY, gridsize, gridsize, blocksize);
 
-        for (int trailIndex = 0; trailIndex < trail -> getLength(); trailIndex++){
+        for (int trailIndex = 0; trailIndex < trail.getLength(); trailIndex++){
 
-        	int xPos = trail -> getPosition(trailIndex).x;
-        	int yPos = trail -> getPosition(trailIndex).y;
+        	int xPos = trail.getPosition(trailIndex).x;
+        	int yPos = trail.getPosition(trailIndex).y;
 
-            arduboy->fillRect(screenPosX + (xPos * blocksize), screenPosY + (yPos * blocksize), blocksize, blocksize, WHITE);
+            fillRect(target, screenPosX + (xPos * blocksize), screenPosY + (yPos * blocksize), blocksize, blocksize);
         }
 
-        arduboy -> fillCircle(screenPosX + (foodX * blocksize) + (blocksize / 2), screenPosY + (foodY * blocksize) + (blocksize / 2), (blocksize - 3) /2, WHITE );
+        fillCircle(target, screenPosX + (foodX * blocksize) + (blocksize / 2), screenPosY + (foodY * blocksize) + (blocksize / 2), (blocksize - 3) /2);
 
     }
 
+    // Everything is drawn inside the grid
+    void getPageSpan(int8_t& first, int8_t& last) const override {
+        first = max(screenPosY, 0) >> 3;
+        last = min(screenPosY + gridsize * blocksize - 1, HEIGHT - 1) >> 3;
+    }
+
+    // Counts frames itself when not run from a Scheduler
     void update() override {
       framecounter++;
       if( framecounter > updatedelay ){
-        framecounter = 0;
-        switch(direction){
-          case(UP_BUTTON):
-            curY--;
-            if( curY < 0 ){
-              curY = 0;
-            }
-            break;
-          case(RIGHT_BUTTON):
-            curX++;
-            if( curX >= gridsize ){
-              curX = gridsize - 1;
-            }
-            break;
-          case(DOWN_BUTTON):
-            curY++;
-            if( curY >= gridsize ){
-              curY = gridsize - 1;
-            }
-            break;
-          case(LEFT_BUTTON):
-            curX--;
-            if( curX < 0 ){
-              curX = 0;
-            }
-            break;
-        }
-        if( justAte ){
-            justAte = false;
-            updatedelay--;
-            if( updatedelay == 0 ){
-                updatedelay = 1;
-            }
-            trail -> increaseLength();
-            setRandomFood();
-        }
-        else if( hasEaten ){
-            bGameOver = trail -> checkGameOver();
-        }
-        trail -> pushHead(curX, curY);
+        step();
       }
+    }
+
+    // Scheduler task, one move per call
+    static uint16_t STEP(void* data){
+      Snake* snake = static_cast<Snake*>(data);
+      snake -> step();
+      return snake -> updatedelay + 1;
+    }
 
-      if( curX == foodX && curY == foodY){
+    // Move one cell, eating and growing as needed
+    void step(){
+      framecounter = 0;
+      switch(direction){
+        case(UP_BUTTON):
+          curY--;
+          if( curY < 0 ){
+            curY = 0;
+          }
+          break;
+        case(RIGHT_BUTTON):
+          curX++;
+          if( curX >= gridsize ){
+            curX = gridsize - 1;
+          }
+          break;
+        case(DOWN_BUTTON):
+          curY++;
+          if( curY >= gridsize ){
+            curY = gridsize - 1;
+          }
+          break;
+        case(LEFT_BUTTON):
+          curX--;
+          if( curX < 0 ){
+            curX = 0;
+          }
+          break;
+      }
+      if( justAte ){
+          justAte = false;
+          updatedelay--;
+          if( updatedelay == 0 ){
+              updatedelay = 1;
+          }
+          trail.increaseLength();
+          setRandomFood();
+      }
+      else if( hasEaten ){
+          bGameOver = trail.checkGameOver();
+      }
+      trail.pushHead(curX, curY);
+
+      if( !justAte && curX == foodX && curY == foodY){
         hasEaten = true;
         justAte = true;
+        if( particles != nullptr ){
+          particles -> burst(screenPosX + (foodX * blocksize) + (blocksize / 2), screenPosY + (foodY * blocksize) + (blocksize / 2), 12, 24, 20);
+        }
       }
-
     }
 };
 
 class Menu : public Controllable, public Renderable{
   public:
-    Menu(ControllerList* inControllerList, Arduboy2* arduboy) : Controllable(inControllerList), Renderable(arduboy){
+    static const byte NUM_CONTROLS = 2; // Added by takeControl
+
+    Menu(ControllerList* inControllerList, Arduboy2Base* arduboy, int inMaxSelection = 3) : Controllable(inControllerList), Renderable(arduboy), nMaxSelection(inMaxSelection){
 
     };
     bool bDisplay = false;
     int nMenuSelection = 0;
-    static const int nMaxSelection = 3;
+    int nMaxSelection;
+    CachedNumber selectionText;
 
     int getSelection(){
       return nMenuSelection;
     }
 
     static void incrementSelection(void* data){
-      int& nMenuSelection = *static_cast<int*>(data);
-      nMenuSelection++;
-      if( nMenuSelection >= nMaxSelection ){
-        nMenuSelection = 0;
+      Menu* menu = static_cast<Menu*>(data);
+      menu -> nMenuSelection++;
+      if( menu -> nMenuSelection >= menu -> nMaxSelection ){
+        menu -> nMenuSelection = 0;
       }
     }
     static void decrementSelection(void* data){
-      int& nMenuSelection = *static_cast<int*>(data);
-      nMenuSelection--;
-      if( nMenuSelection < 0 ){
-        nMenuSelection = nMaxSelection - 1;
+      Menu* menu = static_cast<Menu*>(data);
+      menu -> nMenuSelection--;
+      if( menu -> nMenuSelection < 0 ){
+        menu -> nMenuSelection = menu -> nMaxSelection - 1;
       }
     }
 
-    void render() override {
-      arduboy -> setCursor(64, 0);
-      arduboy -> print( this -> getSelection() );
+    void renderTo(const RenderTarget& target) override {
+      drawText(target, 64, 0, selectionText.format(getSelection()));
+    }
+
+    void getPageSpan(int8_t& first, int8_t& last) const override {
+      first = 0;
+      last = 0;
     }
 
     void takeControl() override {
-      clearControls();
       addControl(BUTTON_JUST_PRESSED, UP_BUTTON, &Menu::decrementSelection, this);
       addControl(BUTTON_JUST_PRESSED, DOWN_BUTTON, &Menu::incrementSelection, this);
     }
@@ -0,0 +1,158 @@
+#ifndef SNAPSHOT
+#define SNAPSHOT
+
+#include <EEPROM.h>
+#include "gameengine.h"
+#include "bitstream.h"
+
+#ifndef SNAPSHOT_EEPROM_START
+#define SNAPSHOT_EEPROM_START EEPROM_STORAGE_SPACE_START
+#endif
+
+const byte SNAPSHOT_MAGIC = 0x5A;
+const byte SNAPSHOT_VERSION = 3; // Bump whenever a save() layout changes
+
+// Saves snapshots round-robin across a few EEPROM slots to spread wear.
+// save() only stages the data in RAM; update() then writes at most one changed byte per
+// frame so an EEPROM write (~3.3ms) never stalls a frame. The slot header is written last,
+// so a slot interrupted mid-write fails its checksum and the previous snapshot stays valid.
+class SnapshotStore : public Updateable {
+  public:
+    static const byte SLOT_COUNT = 4;
+    static const byte SLOT_SIZE = 64;
+    static const byte HEADER_SIZE = 6; // Magic, version, sequence, length, checksum (2)
+    static const byte DATA_SIZE = SLOT_SIZE - HEADER_SIZE;
+
+    // Scan the slots for the newest valid snapshot
+    void begin(){
+      bool bFound = false;
+      for( byte slot = 0; slot < SLOT_COUNT; slot++ ){
+        if( isSlotValid(slot) ){
+          byte sequence = EEPROM.read(slotAddress(slot) + 2);
+          if( !bFound || (int8_t)(sequence - lastSequence) > 0 ){
+            lastSequence = sequence;
+            lastSlot = slot;
+            bFound = true;
+          }
+        }
+      }
+      bHasSnapshot = bFound && EEPROM.read(slotAddress(lastSlot) + 3) > 0;
+    }
+
+    // Stage a snapshot for writing, returns false if it does not fit
+    bool save(const byte* inData, byte inLength){
+      if( inLength > DATA_SIZE ){
+        return false;
+      }
+      writeSlot = (lastSlot + 1) % SLOT_COUNT;
+      writeSequence = lastSequence + 1;
+      if( inLength > 0 ){
+        memcpy(staged + HEADER_SIZE, inData, inLength);
+      }
+      uint16_t checksum = fletcher16(writeSequence, inLength, inData);
+      staged[0] = SNAPSHOT_MAGIC;
+      staged[1] = SNAPSHOT_VERSION;
+      staged[2] = writeSequence;
+      staged[3] = inLength;
+      staged[4] = checksum & 0xFF;
+      staged[5] = checksum >> 8;
+      writeLength = HEADER_SIZE + inLength;
+      writeIndex = 0;
+      bWriting = true;
+      return true;
+    }
+
+    // Supersede the current snapshot with an empty one
+    void clear(){
+      if( bHasSnapshot || bWriting ){
+        save(nullptr, 0);
+      }
+    }
+
+    // Copy the newest snapshot out, returns its length or 0 if there is none
+    byte load(byte* outData){
+      if( !bHasSnapshot ){
+        return 0;
+      }
+      int address = slotAddress(lastSlot);
+      byte length = EEPROM.read(address + 3);
+      for( byte i = 0; i < length; i++ ){
+        outData[i] = EEPROM.read(address + HEADER_SIZE + i);
+      }
+      return length;
+    }
+
+    bool hasSnapshot() const {
+      return bHasSnapshot;
+    }
+
+    bool isWriting() const {
+      return bWriting;
+    }
+
+    void update() override {
+      if( !bWriting ){
+        return;
+      }
+      int address = slotAddress(writeSlot);
+      // Data first, header last. Unchanged bytes are skipped without costing a write.
+      while( writeIndex < writeLength ){
+        byte offset = writeIndex < writeLength - HEADER_SIZE ? HEADER_SIZE + writeIndex : writeIndex - (writeLength - HEADER_SIZE);
+        writeIndex++;
+        if( EEPROM.read(address + offset) != staged[offset] ){
+          EEPROM.write(address + offset, staged[offset]);
+          return;
+        }
+      }
+      bWriting = false;
+      lastSlot = writeSlot;
+      lastSequence = writeSequence;
+      bHasSnapshot = staged[3] > 0;
+    }
+
+  private:
+    byte staged[SLOT_SIZE];
+    byte writeLength = 0;
+    byte writeIndex = 0;
+    byte writeSlot = 0;
+    byte writeSequence = 0;
+    bool bWriting = false;
+    byte lastSlot = SLOT_COUNT - 1;
+    byte lastSequence = 0;
+    bool bHasSnapshot = false;
+
+    static int slotAddress(byte inSlot){
+      return SNAPSHOT_EEPROM_START + inSlot * SLOT_SIZE;
+    }
+
+    static uint16_t fletcher16(byte inSequence, byte inLength, const byte* inData){
+      byte sumA = inSequence;
+      byte sumB = sumA;
+      sumA += inLength;
+      sumB += sumA;
+      for( byte i = 0; i < inLength; i++ ){
+        sumA += inData[i];
+        sumB += sumA;
+      }
+      return sumA | (sumB << 8);
+    }
+
+    bool isSlotValid(byte inSlot){
+      int address = slotAddress(inSlot);
+      if( EEPROM.read(address) != SNAPSHOT_MAGIC || EEPROM.read(address + 1) != SNAPSHOT_VERSION ){
+        return false;
+      }
+      byte length = EEPROM.read(address + 3);
+      if( length > DATA_SIZE ){
+        return false;
+      }
+      byte data[DATA_SIZE];
+      for( byte i = 0; i < length; i++ ){
+        data[i] = EEPROM.read(address + HEADER_SIZE + i);
+      }
+      uint16_t checksum = fletcher16(EEPROM.read(address + 2), length, data);
+      return EEPROM.read(address + 4) == (checksum & 0xFF) && EEPROM.read(address + 5) == (checksum >> 8);
+    }
+};
+
+#endif
@@ -63,57 +63,4 @@ const unsigned char* simpleAnimation[4] = {
   simpleAnimation4
 };
 
-// Controller Art //
-// 'tile000', 16x16px
-const unsigned char sprite_tile000 [] PROGMEM = {
-	0xe0, 0x18, 0xe4, 0xfa, 0xfe, 0x1d, 0x0f, 0x67, 0x67, 0x0f, 0x1d, 0xfe, 0xfa, 0xe4, 0x18, 0xe0, 
-	0x07, 0x18, 0x21, 0x47, 0x4f, 0x8c, 0x9c, 0x9f, 0x9f, 0x9c, 0x8c, 0x4f, 0x47, 0x21, 0x18, 0x07
-};
-// 'tile001', 16x16px
-const unsigned char sprite_tile001 [] PROGMEM = {
-	0xe0, 0x18, 0xe4, 0xfa, 0xfe, 0xe5, 0x47, 0x1f, 0x1f, 0x47, 0xe5, 0xfe, 0xfa, 0xe4, 0x18, 0xe0, 
-	0x07, 0x18, 0x21, 0x47, 0x4f, 0x8c, 0x9c, 0x9f, 0x9f, 0x9c, 0x8c, 0x4f, 0x47, 0x21, 0x18, 0x07
-};
-// 'tile002', 16x16px
-const unsigned char sprite_tile002 [] PROGMEM = {
-	0xe0, 0x18, 0xe4, 0xfa, 0xfe, 0x05, 0x07, 0xb7, 0xb7, 0x07, 0x4d, 0xfe, 0xfa, 0xe4, 0x18, 0xe0, 
-	0x07, 0x18, 0x21, 0x47, 0x4f, 0x8c, 0x9c, 0x9d, 0x9d, 0x9c, 0x8e, 0x4f, 0x47, 0x21, 0x18, 0x07
-};
-// 'tile003', 16x16px
-const unsigned char sprite_tile003 [] PROGMEM = {
-	0xe0, 0x18, 0xe4, 0xfa, 0xfe, 0xe5, 0x87, 0x1f, 0x1f, 0x87, 0xe5, 0xfe, 0xfa, 0xe4, 0x18, 0xe0, 
-	0x07, 0x18, 0x21, 0x47, 0x4f, 0x8f, 0x9f, 0x9c, 0x9c, 0x9f, 0x8f, 0x4f, 0x47, 0x21, 0x18, 0x07
-};
-// 'tile008', 16x16px
-const unsigned char sprite_tile008 [] PROGMEM = {
-	0xe0, 0x10, 0x10, 0x10, 0x1e, 0x01, 0x3d, 0x7d, 0x7d, 0x3d, 0x01, 0x1e, 0x10, 0x10, 0x10, 0xe0, 
-	0x07, 0x08, 0x09, 0x09, 0x79, 0x81, 0x90, 0x90, 0x90, 0x90, 0x81, 0x79, 0x09, 0x09, 0x08, 0x07
-};
-// 'tile009', 16x16px
-const unsigned char sprite_tile009 [] PROGMEM = {
-	0xe0, 0x10, 0x10, 0x10, 0x1e, 0x01, 0x01, 0x81, 0x81, 0x01, 0x01, 0x1e, 0x10, 0x10, 0x10, 0xe0, 
-	0x07, 0x08, 0x09, 0x09, 0x79, 0x80, 0x9e, 0x9f, 0x9f, 0x9e, 0x80, 0x79, 0x09, 0x09, 0x08, 0x07
-};
-// 'tile010', 16x16px
-const unsigned char sprite_tile010 [] PROGMEM = {
-	0xe0, 0x10, 0xd0, 0xd0, 0xde, 0xc1, 0x81, 0x01, 0x01, 0x01, 0x01, 0x1e, 0x10, 0x10, 0x10, 0xe0, 
-	0x07, 0x08, 0x09, 0x09, 0x79, 0x81, 0x90, 0x90, 0x90, 0x90, 0x81, 0x79, 0x09, 0x09, 0x08, 0x07
-};
-// 'tile011', 16x16px
-const unsigned char sprite_tile011 [] PROGMEM = {
-	0xe0, 0x10, 0x10, 0x10, 0x1e, 0x01, 0x01, 0x01, 0x01, 0x81, 0xc1, 0xde, 0xd0, 0xd0, 0x10, 0xe0, 
-	0x07, 0x08, 0x09, 0x09, 0x79, 0x81, 0x90, 0x90, 0x90, 0x90, 0x81, 0x79, 0x09, 0x09, 0x08, 0x07
-};
-
-// Array of all bitmaps for convenience. (Total bytes used to store images in PROGMEM = 384)
-const int sprite_allArray_LEN = 8;
-const unsigned char* sprite_allArray[8] = {
-	sprite_tile000,
-	sprite_tile001,
-	sprite_tile002,
-	sprite_tile003,
-	sprite_tile008,
-	sprite_tile009,
-	sprite_tile010,
-	sprite_tile011
-};
+// The reel tiles are drawn from watermelonPack, built from assets/*.pbm by tools/packassets.py
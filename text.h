@@ -0,0 +1,183 @@
+#ifndef TEXT
+#define TEXT
+
+// 5x7 glyphs, one byte per column with bit 0 at the top, for ' ', '-', '>', '.', ':', 0-9,
+// A-Z and a-z, matching Arduboy2::print. Descenders use the cell's 8th row. Anything else
+// draws as a space.
+const byte GLYPH_WIDTH = 5;
+const byte GLYPH_ADVANCE = 6; // Same 6x8 cell as Arduboy2::print
+const byte textGlyphs[][GLYPH_WIDTH] PROGMEM = {
+  {0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
+  {0x08, 0x08, 0x08, 0x08, 0x08}, // '-'
+  {0x00, 0x41, 0x22, 0x14, 0x08}, // '>'
+  {0x00, 0x60, 0x60, 0x00, 0x00}, // '.'
+  {0x00, 0x00, 0x14, 0x00, 0x00}, // ':'
+  {0x3E, 0x51, 0x49, 0x45, 0x3E}, // '0'
+  {0x00, 0x42, 0x7F, 0x40, 0x00}, // '1'
+  {0x72, 0x49, 0x49, 0x49, 0x46}, // '2'
+  {0x21, 0x41, 0x49, 0x4D, 0x33}, // '3'
+  {0x18, 0x14, 0x12, 0x7F, 0x10}, // '4'
+  {0x27, 0x45, 0x45, 0x45, 0x39}, // '5'
+  {0x3C, 0x4A, 0x49, 0x49, 0x31}, // '6'
+  {0x41, 0x21, 0x11, 0x09, 0x07}, // '7'
+  {0x36, 0x49, 0x49, 0x49, 0x36}, // '8'
+  {0x46, 0x49, 0x49, 0x29, 0x1E}, // '9'
+  {0x7C, 0x12, 0x11, 0x12, 0x7C}, // 'A'
+  {0x7F, 0x49, 0x49, 0x49, 0x36}, // 'B'
+  {0x3E, 0x41, 0x41, 0x41, 0x22}, // 'C'
+  {0x7F, 0x41, 0x41, 0x41, 0x3E}, // 'D'
+  {0x7F, 0x49, 0x49, 0x49, 0x41}, // 'E'
+  {0x7F, 0x09, 0x09, 0x09, 0x01}, // 'F'
+  {0x3E, 0x41, 0x41, 0x51, 0x73}, // 'G'
+  {0x7F, 0x08, 0x08, 0x08, 0x7F}, // 'H'
+  {0x00, 0x41, 0x7F, 0x41, 0x00}, // 'I'
+  {0x20, 0x40, 0x41, 0x3F, 0x01}, // 'J'
+  {0x7F, 0x08, 0x14, 0x22, 0x41}, // 'K'
+  {0x7F, 0x40, 0x40, 0x40, 0x40}, // 'L'
+  {0x7F, 0x02, 0x1C, 0x02, 0x7F}, // 'M'
+  {0x7F, 0x04, 0x08, 0x10, 0x7F}, // 'N'
+  {0x3E, 0x41, 0x41, 0x41, 0x3E}, // 'O'
+  {0x7F, 0x09, 0x09, 0x09, 0x06}, // 'P'
+  {0x3E, 0x41, 0x51, 0x21, 0x5E}, // 'Q'
+  {0x7F, 0x09, 0x19, 0x29, 0x46}, // 'R'
+  {0x26, 0x49, 0x49, 0x49, 0x32}, // 'S'
+  {0x03, 0x01, 0x7F, 0x01, 0x03}, // 'T'
+  {0x3F, 0x40, 0x40, 0x40, 0x3F}, // 'U'
+  {0x1F, 0x20, 0x40, 0x20, 0x1F}, // 'V'
+  {0x3F, 0x40, 0x38, 0x40, 0x3F}, // 'W'
+  {0x63, 0x14, 0x08, 0x14, 0x63}, // 'X'
+  {0x03, 0x04, 0x78, 0x04, 0x03}, // 'Y'
+  {0x61, 0x59, 0x49, 0x4D, 0x43}, // 'Z'
+  {0x20, 0x54, 0x54, 0x54, 0x78}, // 'a'
+  {0x7F, 0x48, 0x44, 0x44, 0x38}, // 'b'
+  {0x38, 0x44, 0x44, 0x44, 0x20}, // 'c'
+  {0x38, 0x44, 0x44, 0x48, 0x7F}, // 'd'
+  {0x38, 0x54, 0x54, 0x54, 0x18}, // 'e'
+  {0x08, 0x7E, 0x09, 0x01, 0x02}, // 'f'
+  {0x18, 0xA4, 0xA4, 0xA4, 0x7C}, // 'g'
+  {0x7F, 0x08, 0x04, 0x04, 0x78}, // 'h'
+  {0x00, 0x44, 0x7D, 0x40, 0x00}, // 'i'
+  {0x20, 0x40, 0x44, 0x3D, 0x00}, // 'j'
+  {0x00, 0x7F, 0x10, 0x28, 0x44}, // 'k'
+  {0x00, 0x41, 0x7F, 0x40, 0x00}, // 'l'
+  {0x7C, 0x04, 0x18, 0x04, 0x78}, // 'm'
+  {0x7C, 0x08, 0x04, 0x04, 0x78}, // 'n'
+  {0x38, 0x44, 0x44, 0x44, 0x38}, // 'o'
+  {0xFC, 0x18, 0x24, 0x24, 0x18}, // 'p'
+  {0x18, 0x24, 0x24, 0x18, 0xFC}, // 'q'
+  {0x7C, 0x08, 0x04, 0x04, 0x08}, // 'r'
+  {0x48, 0x54, 0x54, 0x54, 0x24}, // 's'
+  {0x04, 0x04, 0x3F, 0x44, 0x24}, // 't'
+  {0x3C, 0x40, 0x40, 0x20, 0x7C}, // 'u'
+  {0x1C, 0x20, 0x40, 0x20, 0x1C}, // 'v'
+  {0x3C, 0x40, 0x30, 0x40, 0x3C}, // 'w'
+  {0x44, 0x28, 0x10, 0x28, 0x44}, // 'x'
+  {0x4C, 0x90, 0x90, 0x90, 0x7C}, // 'y'
+  {0x44, 0x64, 0x54, 0x4C, 0x44}  // 'z'
+};
+
+inline byte glyphIndex(char c){
+  if( c >= '0' && c <= '9' ){
+    return 5 + (c - '0');
+  }
+  if( c >= 'A' && c <= 'Z' ){
+    return 15 + (c - 'A');
+  }
+  if( c >= 'a' && c <= 'z' ){
+    return 41 + (c - 'a');
+  }
+  return c == '-' ? 1 : c == '>' ? 2 : c == '.' ? 3 : c == ':' ? 4 : 0;
+}
+
+// Formats inValue into outText (at least 7 bytes) without dividing, using double dabble
+// on the magnitude. Returns the number of characters written.
+inline byte formatNumber(int inValue, char* outText){
+  byte length = 0;
+  uint16_t binary = inValue < 0 ? -(long)inValue : inValue;
+  if( inValue < 0 ){
+    outText[length++] = '-';
+  }
+
+  // 5 BCD digits in the low 20 bits of bcd
+  uint32_t bcd = 0;
+  for( byte bit = 0; bit < 16; bit++ ){
+    for( byte digit = 0; digit < 20; digit += 4 ){
+      if( ((bcd >> digit) & 0xF) >= 5 ){
+        bcd += 3UL << digit;
+      }
+    }
+    bcd = (bcd << 1) | ((binary >> 15) & 1);
+    binary <<= 1;
+  }
+
+  bool bLeading = true;
+  for( int8_t digit = 16; digit >= 0; digit -= 4 ){
+    byte value = (bcd >> digit) & 0xF;
+    if( value != 0 || !bLeading || digit == 0 ){
+      outText[length++] = '0' + value;
+      bLeading = false;
+    }
+  }
+  outText[length] = '\0';
+  return length;
+}
+
+// Draws text into the target in 6x8 cells, clearing the cell background like
+// Arduboy2::print. Rows on a page boundary write whole bytes; other rows mask across two pages.
+inline void drawText(const RenderTarget& target, int x, int y, const char* text){
+  if( y <= -8 || y >= HEIGHT ){
+    return;
+  }
+  int8_t page = y >> 3;
+  byte shift = y & 7;
+  if( !target.hasPage(page) && !(shift != 0 && target.hasPage(page + 1)) ){
+    return;
+  }
+  RENDER_STAT_CALL();
+  uint16_t cellMask = 0xFF << shift; // The 8 rows of the cell, across both pages
+  for( ; *text != '\0'; text++ ){
+    const byte* glyph = textGlyphs[glyphIndex(*text)];
+    for( byte column = 0; column < GLYPH_ADVANCE; column++, x++ ){
+      if( x < 0 || x >= WIDTH ){
+        continue;
+      }
+      byte bits = column < GLYPH_WIDTH ? pgm_read_byte(&glyph[column]) : 0;
+      if( shift == 0 ){
+        RENDER_STAT_WRITE(page, x, target.column(page, x), 0xFF); // The whole cell is redrawn
+        target.column(page, x) = bits;
+      }
+      else{
+        uint16_t shifted = (uint16_t)bits << shift;
+        if( target.hasPage(page) ){
+          uint8_t& top = target.column(page, x);
+          RENDER_STAT_WRITE(page, x, top, cellMask & 0xFF);
+          top = (top & ~(cellMask & 0xFF)) | (shifted & 0xFF);
+        }
+        if( target.hasPage(page + 1) ){
+          uint8_t& bottom = target.column(page + 1, x);
+          RENDER_STAT_WRITE(page + 1, x, bottom, cellMask >> 8);
+          bottom = (bottom & ~(cellMask >> 8)) | (shifted >> 8);
+        }
+      }
+    }
+  }
+}
+
+// Keeps the formatted text of a number between frames, only re-formatting when it changes
+class CachedNumber{
+  public:
+    int value = 0;
+    bool bValid = false;
+    char text[7];
+
+    const char* format(int inValue){
+      if( !bValid || inValue != value ){
+        value = inValue;
+        bValid = true;
+        formatNumber(inValue, text);
+      }
+      return text;
+    }
+};
+
+#endif
@@ -0,0 +1,197 @@
+"""Frame recordings: whole 1KB framebuffers kept as XOR deltas, run-length encoded.
+
+    header   'A', 'F', version, 0         only at the start of the file
+    record   kind, payload length (uint16 LE), payload
+             kind 'K' is a keyframe: the frame itself
+             kind 'D' is a delta: the frame XORed with the one before
+Payloads are a stream of ops:
+    0nnnnnnn  n + 1 literal bytes follow
+    1nnnnnnn  the next byte repeated n + 2 times
+Recordings are appendable. Each recording starts on a keyframe and writes another every
+KEYFRAME_INTERVAL frames, so a player can seek without decoding from the start. A record
+cut short by a crash is ignored.
+
+framefile.py FILE prints what a recording holds.
+"""
+import queue
+import sys
+import threading
+
+WIDTH = 128
+HEIGHT = 64
+FRAME_SIZE = WIDTH * HEIGHT // 8
+VERSION = 1
+HEADER = bytes([ord('A'), ord('F'), VERSION, 0])
+KEYFRAME = ord('K')
+DELTA = ord('D')
+KEYFRAME_INTERVAL = 60  # One a second at the default frame rate
+QUEUE_FRAMES = 120
+
+OP_LITERAL = 0x00  # 0nnnnnnn: n + 1 bytes follow
+OP_REPEAT = 0x80   # 1nnnnnnn: next byte repeated n + 2 times
+MAX_LITERAL = 128
+MAX_REPEAT = 129
+
+
+def append_literals(out, data, start, end):
+    while start < end:
+        count = min(end - start, MAX_LITERAL)
+        out.append(OP_LITERAL | (count - 1))
+        out.extend(data[start:start + count])
+        start += count
+
+
+def encode(data):
+    out = bytearray()
+    literal_start = 0
+    i = 0
+    size = len(data)
+    while i < size:
+        value = data[i]
+        run = 1
+        while i + run < size and data[i + run] == value and run < MAX_REPEAT:
+            run += 1
+        if run >= 3:
+            append_literals(out, data, literal_start, i)
+            out.append(OP_REPEAT | (run - 2))
+            out.append(value)
+            literal_start = i + run
+        i += run
+    append_literals(out, data, literal_start, size)
+    return bytes(out)
+
+
+def decode(payload):
+    out = bytearray()
+    i = 0
+    while i < len(payload):
+        op = payload[i]
+        if op & OP_REPEAT:
+            out += bytes([payload[i + 1]]) * ((op & 0x7F) + 2)
+            i += 2
+        else:
+            count = op + 1
+            out += payload[i + 1:i + 1 + count]
+            i += 1 + count
+    if len(out) != FRAME_SIZE:
+        raise ValueError('frame decodes to %d bytes' % len(out))
+    return out
+
+
+def xor(a, b):
+    return (int.from_bytes(a, 'little') ^ int.from_bytes(b, 'little')).to_bytes(FRAME_SIZE, 'little')
+
+
+class Recorder:
+    """Appends frames to a recording from a background thread.
+
+    add() only copies the frame onto a bounded queue, so a slow disk never holds up the
+    caller. When the queue is full the frame is dropped and counted; deltas are taken
+    against the last frame written, so the recording stays consistent.
+    """
+
+    def __init__(self, path):
+        self.file = open(path, 'ab')
+        if self.file.tell() == 0:
+            self.file.write(HEADER)
+        else:
+            # Drop a record cut short last time, so this one starts on a record boundary
+            end = Reader(path).end
+            self.file.truncate(end)
+            self.file.seek(end)
+        self.frames = queue.Queue(QUEUE_FRAMES)
+        self.written = 0
+        self.dropped = 0
+        self.thread = threading.Thread(target=self.run, daemon=True)
+        self.thread.start()
+
+    def add(self, framebuffer):
+        try:
+            self.frames.put_nowait(bytes(framebuffer))
+        except queue.Full:
+            self.dropped += 1
+
+    def close(self):
+        self.frames.put(None)
+        self.thread.join()
+        self.file.close()
+
+    def run(self):
+        previous = None
+        since_keyframe = 0
+        while True:
+            frame = self.frames.get()
+            if frame is None:
+                break
+            if previous is None or since_keyframe >= KEYFRAME_INTERVAL:
+                kind = KEYFRAME
+                payload = encode(frame)
+                since_keyframe = 0
+            else:
+                kind = DELTA
+                payload = encode(xor(frame, previous))
+            self.file.write(bytes([kind, len(payload) & 0xFF, len(payload) >> 8]))
+            self.file.write(payload)
+            previous = frame
+            since_keyframe += 1
+            self.written += 1
+
+
+class Reader:
+    """Random access to the frames of a recording."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:len(HEADER)] != HEADER:
+            raise ValueError('%s is not a version %d recording' % (path, VERSION))
+        self.records = []    # (kind, payload start, payload end) per frame
+        self.keyframes = []  # Frame numbers
+        pos = len(HEADER)
+        while pos + 3 <= len(self.data):
+            kind = self.data[pos]
+            end = pos + 3 + (self.data[pos + 1] | self.data[pos + 2] << 8)
+            if kind not in (KEYFRAME, DELTA) or end > len(self.data):
+                break  # Cut short
+            if kind == KEYFRAME:
+                self.keyframes.append(len(self.records))
+            elif not self.keyframes:
+                break
+            self.records.append((kind, pos + 3, end))
+            pos = end
+        self.end = pos  # Where the valid records stop
+        self.current = None  # (frame number, frame) last decoded
+
+    def __len__(self):
+        return len(self.records)
+
+    def frame(self, number):
+        if self.current is not None and self.current[0] <= number:
+            start, frame = self.current
+        else:
+            start = None
+        # Go from the nearest keyframe unless stepping on from the last frame is shorter
+        keyframe = max(k for k in self.keyframes if k <= number)
+        if start is None or keyframe > start:
+            start = keyframe
+            frame = self.payload(keyframe)
+        for n in range(start + 1, number + 1):
+            if self.records[n][0] == KEYFRAME:
+                frame = self.payload(n)
+            else:
+                frame = xor(frame, self.payload(n))
+        self.current = (number, frame)
+        return frame
+
+    def payload(self, number):
+        kind, start, end = self.records[number]
+        return decode(self.data[start:end])
+
+    def size(self):
+        return len(self.data)
+
+
+if __name__ == '__main__':
+    reader = Reader(sys.argv[1])
+    print('%d frames, %d keyframes, %d bytes (%.1f per frame)' % (
+        len(reader), len(reader.keyframes), reader.size(), reader.size() / max(1, len(reader))))
@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+"""Packs 1-bit PBM images into an asset pack header for assets.h.
+
+    packassets.py [--compress] [--bin PATH] NAME OUTPUT.h IMAGE.pbm[:FRAME_HEIGHT] ...
+
+Each image becomes one sprite named after its file. Frames are stacked top to bottom,
+FRAME_HEIGHT pixels each (default: the whole image is one frame). Writes a PROGMEM
+array NAMEPack[] and an enum of sprite indices. --bin PATH also writes the raw pack.
+
+--compress run-length encodes sprites, optionally as a delta against an earlier raw
+sprite of the same size, whenever that is smaller than the raw frames. The flash
+saved per sprite is printed to stderr.
+"""
+import os
+import sys
+
+VERSION = 2
+HEADER_SIZE = 4
+ENTRY_SIZE = 6
+FLAG_COMPRESSED = 0x80  # Low 7 bits of the flags are the base sprite + 1, 0 for none
+
+# Compressed frame ops, see AssetPack::drawCompressed
+OP_LITERAL = 0x00  # 0nnnnnnn: n + 1 bytes follow
+OP_REPEAT = 0x80   # 10nnnnnn: next byte repeated n + 2 times
+OP_BASE = 0xC0     # 11nnnnnn: n + 1 bytes copied from the base frame
+
+
+def read_tokens(data):
+    # PBM header tokens, skipping comments
+    tokens = []
+    pos = 0
+    while len(tokens) < 3:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b'#':
+            while data[pos:pos + 1] not in (b'\n', b''):
+                pos += 1
+            continue
+        start = pos
+        while not data[pos:pos + 1].isspace():
+            pos += 1
+        tokens.append(data[start:pos])
+    return tokens, pos + 1
+
+
+def read_pbm(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+    (magic, width, height), pos = read_tokens(data)
+    width, height = int(width), int(height)
+    if magic == b'P1':
+        bits = [int(c) for c in data[pos:].decode() if c in '01']
+        rows = [bits[y * width:(y + 1) * width] for y in range(height)]
+    elif magic == b'P4':
+        stride = (width + 7) // 8
+        rows = []
+        for y in range(height):
+            line = data[pos + y * stride:pos + (y + 1) * stride]
+            rows.append([(line[x >> 3] >> (7 - (x & 7))) & 1 for x in range(width)])
+    else:
+        sys.exit('%s: not a PBM file' % path)
+    return width, height, rows
+
+
+def to_pages(rows, width, top, height):
+    # drawBitmap order: 8 pixel tall pages, one byte per column, bit 0 at the top
+    out = bytearray()
+    for page in range((height + 7) // 8):
+        for x in range(width):
+            value = 0
+            for bit in range(8):
+                y = page * 8 + bit
+                if y < height and rows[top + y][x]:
+                    value |= 1 << bit
+            out.append(value)
+    return out
+
+
+def run_length(values, start, limit):
+    count = 1
+    while start + count < len(values) and count < limit and values[start + count] == values[start]:
+        count += 1
+    return count
+
+
+def base_length(frame, base, start, limit):
+    count = 0
+    while base is not None and start + count < len(frame) and count < limit and frame[start + count] == base[start + count]:
+        count += 1
+    return count
+
+
+def compress_frame(frame, base):
+    out = bytearray()
+    literal = bytearray()
+
+    def flush():
+        while literal:
+            chunk = literal[:128]
+            out.append(OP_LITERAL | (len(chunk) - 1))
+            out.extend(chunk)
+            del literal[:128]
+
+    i = 0
+    while i < len(frame):
+        copy = base_length(frame, base, i, 64)
+        repeat = run_length(frame, i, 65)
+        if copy >= 2 and copy >= repeat:
+            flush()
+            out.append(OP_BASE | (copy - 1))
+            i += copy
+        elif repeat >= 3:
+            flush()
+            out.append(OP_REPEAT | (repeat - 2))
+            out.append(frame[i])
+            i += repeat
+        else:
+            literal.append(frame[i])
+            i += 1
+    flush()
+    return out
+
+
+def pack(images, compress):
+    sprites = []
+    for path, frame_height in images:
+        width, height, rows = read_pbm(path)
+        frame_height = frame_height or height
+        if height % frame_height:
+            sys.exit('%s: height %d is not a multiple of %d' % (path, height, frame_height))
+        frames = height // frame_height
+        if width > 255 or frame_height > 255 or frames > 255:
+            sys.exit('%s: too large' % path)
+        sprites.append((path, width, frame_height,
+                        [to_pages(rows, width, f * frame_height, frame_height) for f in range(frames)]))
+
+    # Pick raw or compressed per sprite. Only raw sprites can be a base, since the
+    # decoder reads the base frame straight from flash.
+    encoded = []
+    raw_sprites = []
+    for index, (path, width, height, frames) in enumerate(sprites):
+        raw = b''.join(frames)
+        best = (len(raw), 0, None)
+        if compress:
+            candidates = [None] + [i for i in raw_sprites if sprites[i][1:3] == (width, height)]
+            for base_index in candidates:
+                base = sprites[base_index][3][0] if base_index is not None else None
+                blobs = [compress_frame(frame, base) for frame in frames]
+                size = 2 * len(frames) + sum(len(b) for b in blobs)
+                if size < best[0]:
+                    best = (size, FLAG_COMPRESSED | (base_index + 1 if base_index is not None else 0), blobs)
+            name = os.path.basename(path)
+            base_note = ' against %s' % os.path.basename(sprites[(best[1] & 0x7F) - 1][0]) if best[1] & 0x7F else ''
+            sys.stderr.write('%s: raw %d bytes, packed %d bytes%s\n' % (name, len(raw), best[0], base_note))
+        if best[2] is None:
+            raw_sprites.append(index)
+        encoded.append((width, height, len(frames), best[1], raw if best[2] is None else best[2]))
+
+    entries = bytearray()
+    data = bytearray()
+    start = HEADER_SIZE + ENTRY_SIZE * len(sprites)
+    for width, height, frames, flags, payload in encoded:
+        offset = start + len(data)
+        entries += bytes([width, height, frames, flags, offset & 0xFF, offset >> 8])
+        if flags & FLAG_COMPRESSED:
+            # Frame table of pack offsets, then the frames
+            frame_offset = offset + 2 * frames
+            for blob in payload:
+                data += bytes([frame_offset & 0xFF, frame_offset >> 8])
+                frame_offset += len(blob)
+            for blob in payload:
+                data += blob
+        else:
+            data += payload
+    if start + len(data) > 0xFFFF:
+        sys.exit('pack is over 64KB')
+    if compress:
+        raw_total = sum(len(b''.join(frames)) for _, _, _, frames in sprites)
+        sys.stderr.write('total: raw %d bytes, packed %d bytes, saved %d\n' % (raw_total, len(data), raw_total - len(data)))
+    return bytes([ord('A'), ord('P'), VERSION, len(sprites)]) + entries + data
+
+
+def main(argv):
+    bin_path = None
+    compress = '--compress' in argv
+    if compress:
+        argv.remove('--compress')
+    if '--bin' in argv:
+        i = argv.index('--bin')
+        bin_path = argv[i + 1]
+        del argv[i:i + 2]
+    if len(argv) < 3:
+        sys.exit(__doc__)
+    name, output, specs = argv[0], argv[1], argv[2:]
+    images = []
+    for spec in specs:
+        path, _, frame_height = spec.partition(':')
+        images.append((path, int(frame_height) if frame_height else 0))
+    blob = pack(images, compress)
+
+    guard = name.upper() + '_PACK'
+    command = ' '.join(['tools/packassets.py'] + sys.argv[1:])
+    lines = ['// Generated by tools/packassets.py, do not edit. Rebuild with:', '//   ' + command,
+             '#ifndef ' + guard, '#define ' + guard, '']
+    lines.append('enum %sSprite {' % (name[0].upper() + name[1:]))
+    for path, _ in images:
+        sprite = os.path.splitext(os.path.basename(path))[0]
+        lines.append('  %s_%s,' % (name.upper(), sprite.upper()))
+    lines.append('  %s_COUNT' % name.upper())
+    lines.append('};')
+    lines.append('')
+    lines.append('const byte %sPack[] PROGMEM = {' % name)
+    for i in range(0, len(blob), 16):
+        lines.append('  ' + ' '.join('0x%02x,' % b for b in blob[i:i + 16]))
+    lines.append('};')
+    lines.append('')
+    lines.append('#endif')
+    with open(output, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+    if bin_path:
+        with open(bin_path, 'wb') as f:
+            f.write(blob)
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Plays a recording made with viewer.py --record in the terminal.
+
+    player.py [--half] [--from FRAME] [--fps N] FILE
+
+Keys: space pauses, left and right seek a second, , and . step a frame while paused,
+q quits. Seeking starts from the nearest keyframe, so it is quick anywhere in the file.
+"""
+import os
+import select
+import sys
+import termios
+import time
+import tty
+
+import framefile
+import viewer
+
+KEYS = {
+    b'\x1b[C': 'forward', b'\x1b[D': 'back', b' ': 'pause',
+    b'.': 'step', b',': 'unstep', b'q': 'quit', b'\x03': 'quit',
+}
+
+
+def read_keys(data):
+    actions = []
+    while data:
+        for key, action in KEYS.items():
+            if data.startswith(key):
+                actions.append(action)
+                data = data[len(key):]
+                break
+        else:
+            data = data[1:]
+    return actions
+
+
+def main(args):
+    half = False
+    start = 0
+    fps = 60.0
+    while args and args[0].startswith('--'):
+        option = args.pop(0)
+        if option == '--half':
+            half = True
+        elif option == '--from' and args:
+            start = int(args.pop(0))
+        elif option == '--fps' and args:
+            fps = float(args.pop(0))
+        else:
+            args = []
+    if len(args) != 1:
+        sys.stderr.write(__doc__)
+        return 1
+
+    reader = framefile.Reader(args[0])
+    if len(reader) == 0:
+        sys.stderr.write('%s holds no frames\n' % args[0])
+        return 1
+    screen = viewer.Screen(half)
+    stdin = sys.stdin.fileno()
+    saved = termios.tcgetattr(stdin)
+    tty.setraw(stdin)
+    out = sys.stdout
+    out.write('\x1b[?1049h\x1b[?25l\x1b[2J')
+    number = min(max(start, 0), len(reader) - 1)
+    paused = False
+    shown = None
+    next_time = time.time()
+    try:
+        while True:
+            if number != shown:
+                screen.set_frame(reader.frame(number))
+                out.write(screen.flush())
+                out.write('\x1b[%d;1H\x1b[K%d / %d%s' % (
+                    screen.rows + 1, number, len(reader) - 1, '  paused' if paused else ''))
+                out.flush()
+                shown = number
+            wait = max(0.0, next_time - time.time()) if not paused else None
+            ready, _, _ = select.select([stdin], [], [], wait)
+            if stdin in ready:
+                for action in read_keys(os.read(stdin, 64)):
+                    if action == 'quit':
+                        return 0
+                    if action == 'pause':
+                        paused = not paused
+                        next_time = time.time()  # Not catching up on the time spent paused
+                        shown = None  # Redraw the status line
+                    elif action == 'forward':
+                        number = min(number + int(fps), len(reader) - 1)
+                    elif action == 'back':
+                        number = max(number - int(fps), 0)
+                    elif action == 'step' and paused:
+                        number = min(number + 1, len(reader) - 1)
+                    elif action == 'unstep' and paused:
+                        number = max(number - 1, 0)
+                continue
+            if not paused:
+                next_time += 1.0 / fps
+                if number < len(reader) - 1:
+                    number += 1
+                else:
+                    paused = True
+                    shown = None
+    finally:
+        termios.tcsetattr(stdin, termios.TCSADRAIN, saved)
+        out.write('\x1b[?25h\x1b[?1049l')
+        out.flush()
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
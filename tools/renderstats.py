@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+"""Summarises the Serial output of a RENDER_STATS build, see renderstats.h.
+
+    renderstats.py [LOG]
+
+Reads the render and heat lines from LOG, or stdin, e.g. a capture of the serial port.
+Other lines are skipped. Prints each RenderList slot's average draw calls, bytes written
+and overdraw per reported frame, then the overdraw heatmap summed over all of them, one
+character per 16x8 tile.
+"""
+import sys
+
+TILE_COLUMNS = 8
+TILE_ROWS = 8
+SHADES = ' .:-=+*#%@'
+
+
+def main(args):
+    source = open(args[0]) if args else sys.stdin
+    totals = {}  # Slot to [calls, bytes, overdraw]
+    heat = [0] * (TILE_COLUMNS * TILE_ROWS)
+    frames = set()
+    for line in source:
+        fields = line.strip().split(',')
+        if fields[0] == 'render' and len(fields) == 6:
+            frames.add(fields[1])
+            slot = totals.setdefault(int(fields[2]), [0, 0, 0])
+            for i in range(3):
+                slot[i] += int(fields[3 + i])
+        elif fields[0] == 'heat' and len(fields) == 2 + len(heat):
+            frames.add(fields[1])
+            for tile in range(len(heat)):
+                heat[tile] += int(fields[2 + tile])
+    if not frames:
+        sys.stderr.write('no render stats found\n')
+        return 1
+
+    count = len(frames)
+    print('%d frames' % count)
+    print('slot  calls   bytes  overdraw')
+    for slot in sorted(totals):
+        calls, written, overdraw = totals[slot]
+        print('%4d %6.1f %7.1f %9.1f' % (slot, calls / count, written / count, overdraw / count))
+
+    peak = max(heat)
+    print('overdraw heatmap, peak tile %.1f per frame' % (peak / count))
+    for row in range(TILE_ROWS):
+        cells = heat[row * TILE_COLUMNS:(row + 1) * TILE_COLUMNS]
+        print('|' + ''.join(SHADES[(len(SHADES) - 1) * value // peak] if peak else ' ' for value in cells) + '|')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
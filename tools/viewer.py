@@ -0,0 +1,260 @@
+#!/usr/bin/env python3
+"""Shows an Arduboy built with SERIAL_VIEWER true in the terminal and plays it from the keyboard.
+
+    viewer.py [--half] [--hold SECONDS] [--record FILE] PORT
+
+PORT is the Arduboy's USB serial device, e.g. /dev/ttyACM0. The screen is drawn with
+quadrant blocks, 2x2 pixels per cell in 64x32 cells, or with --half as half blocks,
+1x2 pixels per cell in 128x32 cells. Only the cells that changed are redrawn, so it keeps
+up over ssh.
+
+--record appends every frame to FILE, see framefile.py. tools/player.py plays it back.
+
+Keys: arrows move, z or a is A, x or s is B, r redraws everything, q quits. Terminals
+only report key presses, so a button stays held for --hold seconds after its last repeat.
+
+The stream is described in mirror.h.
+"""
+import os
+import select
+import sys
+import termios
+import time
+import tty
+
+import framefile
+
+WIDTH = 128
+HEIGHT = 64
+CHUNK_WIDTH = 16
+CHUNKS_PER_PAGE = WIDTH // CHUNK_WIDTH
+CHUNK_MARK = 0xA5
+FRAME_MARK = 0x5A
+RESYNC = 0x01
+
+# Arduboy2 button bits
+UP = 0x80
+RIGHT = 0x40
+LEFT = 0x20
+DOWN = 0x10
+A = 0x08
+B = 0x04
+
+KEYS = {
+    b'\x1b[A': UP, b'\x1b[B': DOWN, b'\x1b[C': RIGHT, b'\x1b[D': LEFT,
+    b'z': A, b'a': A, b'x': B, b's': B,
+}
+
+# Indexed by top left 1, top right 2, bottom left 4, bottom right 8
+QUADRANTS = ' ▘▝▀▖▌▞▛▗▚▐▜▄▙▟█'
+# Indexed by top 1, bottom 2
+HALVES = ' ▀▄█'
+
+FIRST_HOLD = 0.6  # Covers the terminal's delay before it starts repeating
+
+
+class Screen:
+    def __init__(self, half):
+        self.half = half
+        self.cell_width = 1 if half else 2
+        self.columns = WIDTH // self.cell_width
+        self.rows = HEIGHT // 2
+        self.framebuffer = bytearray(WIDTH * HEIGHT // 8)
+        self.cells = [None] * (self.columns * self.rows)  # What the terminal shows
+        self.dirty = set()  # Chunks changed since the last frame
+
+    def set_chunk(self, chunk, data):
+        start = (chunk // CHUNKS_PER_PAGE) * WIDTH + (chunk % CHUNKS_PER_PAGE) * CHUNK_WIDTH
+        self.framebuffer[start:start + CHUNK_WIDTH] = data
+        self.dirty.add(chunk)
+
+    def set_frame(self, frame):
+        self.framebuffer[:] = frame
+        self.dirty = set(range(CHUNKS_PER_PAGE * HEIGHT // 8))
+
+    def pixel(self, x, y):
+        return (self.framebuffer[(y >> 3) * WIDTH + x] >> (y & 7)) & 1
+
+    def cell(self, column, row):
+        x = column * self.cell_width
+        y = row * 2
+        if self.half:
+            return HALVES[self.pixel(x, y) | self.pixel(x, y + 1) << 1]
+        return QUADRANTS[self.pixel(x, y) | self.pixel(x + 1, y) << 1 |
+                         self.pixel(x, y + 1) << 2 | self.pixel(x + 1, y + 1) << 3]
+
+    def redraw(self):
+        self.cells = [None] * len(self.cells)
+        self.dirty = set(range(CHUNKS_PER_PAGE * HEIGHT // 8))
+
+    # Escape sequences drawing the cells the dirty chunks changed
+    def flush(self):
+        out = []
+        chunk_columns = CHUNK_WIDTH // self.cell_width
+        cursor = None
+        for chunk in sorted(self.dirty):
+            page_row = (chunk // CHUNKS_PER_PAGE) * 4  # A page is 4 cell rows
+            first_column = (chunk % CHUNKS_PER_PAGE) * chunk_columns
+            for row in range(page_row, page_row + 4):
+                for column in range(first_column, first_column + chunk_columns):
+                    text = self.cell(column, row)
+                    index = row * self.columns + column
+                    if self.cells[index] == text:
+                        continue
+                    self.cells[index] = text
+                    if cursor != (row, column):
+                        out.append('\x1b[%d;%dH' % (row + 1, column + 1))
+                    out.append(text)
+                    cursor = (row, column + 1)
+        self.dirty.clear()
+        return ''.join(out)
+
+
+class Stream:
+    """Parses the mirror stream into a Screen, calling on_frame as each frame completes."""
+
+    def __init__(self, screen, on_frame):
+        self.screen = screen
+        self.on_frame = on_frame
+        self.pending = bytearray()
+
+    def feed(self, data):
+        pending = self.pending
+        pending += data
+        while pending:
+            if pending[0] == CHUNK_MARK:
+                if len(pending) < 2 + CHUNK_WIDTH:
+                    break
+                if pending[1] < CHUNKS_PER_PAGE * HEIGHT // 8:
+                    self.screen.set_chunk(pending[1], pending[2:2 + CHUNK_WIDTH])
+                del pending[:2 + CHUNK_WIDTH]
+            elif pending[0] == FRAME_MARK:
+                if len(pending) < 2:
+                    break
+                del pending[:2]
+                self.on_frame()
+            else:
+                del pending[:1]  # Lost sync, skip to the next mark
+
+
+class Buttons:
+    def __init__(self, hold):
+        self.hold = hold
+        self.until = {}  # Button bit to the time it is released
+
+    def press(self, button, now):
+        held = self.until.get(button, 0) > now
+        self.until[button] = now + (self.hold if held else max(self.hold, FIRST_HOLD))
+
+    def mask(self, now):
+        mask = 0
+        for button, until in self.until.items():
+            if until > now:
+                mask |= button
+        return mask
+
+
+def open_port(path):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+    tty.setraw(fd)
+    attrs = termios.tcgetattr(fd)
+    attrs[4] = attrs[5] = termios.B115200  # Anything but 1200, which resets into the bootloader
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    return fd
+
+
+def read_keys(data, buttons, now):
+    # Returns 'quit', 'redraw' or None
+    action = None
+    while data:
+        for key, button in KEYS.items():
+            if data.startswith(key):
+                buttons.press(button, now)
+                data = data[len(key):]
+                break
+        else:
+            if data[:1] in (b'q', b'\x03'):
+                return 'quit'
+            if data[:1] == b'r':
+                action = 'redraw'
+            data = data[1:]
+    return action
+
+
+def main(args):
+    half = False
+    hold = 0.15
+    record = None
+    while args and args[0].startswith('--'):
+        option = args.pop(0)
+        if option == '--half':
+            half = True
+        elif option == '--hold' and args:
+            hold = float(args.pop(0))
+        elif option == '--record' and args:
+            record = args.pop(0)
+        else:
+            args = []
+    if len(args) != 1:
+        sys.stderr.write(__doc__)
+        return 1
+
+    port = open_port(args[0])
+    screen = Screen(half)
+    buttons = Buttons(hold)
+    stdin = sys.stdin.fileno()
+    saved = termios.tcgetattr(stdin)
+    tty.setraw(stdin)
+    out = sys.stdout
+    out.write('\x1b[?1049h\x1b[?25l\x1b[2J')
+    recorder = framefile.Recorder(record) if record is not None else None
+    frames = [0]
+
+    def on_frame():
+        frames[0] += 1
+        if recorder is not None:
+            recorder.add(screen.framebuffer)
+        out.write(screen.flush())  # Per frame, so a read holding several never skips one
+
+    stream = Stream(screen, on_frame)
+    sent = None
+    rate_start = time.time()
+    try:
+        while True:
+            ready, _, _ = select.select([port, stdin], [], [], 0.02)
+            now = time.time()
+            if stdin in ready:
+                action = read_keys(os.read(stdin, 64), buttons, now)
+                if action == 'quit':
+                    break
+                if action == 'redraw':
+                    screen.redraw()
+                    out.write('\x1b[2J')
+                    sent = None  # Send the resync with the next mask
+            if port in ready:
+                stream.feed(os.read(port, 4096))
+            if now - rate_start >= 1.0:
+                fps = frames[0] / (now - rate_start)
+                frames[0] = 0
+                rate_start = now
+                status = '%.1f fps' % fps
+                if recorder is not None:
+                    status += '  recording %d frames' % recorder.written
+                out.write('\x1b[%d;1H\x1b[K%s' % (screen.rows + 1, status))
+            out.flush()
+            mask = buttons.mask(now)
+            if mask != sent:
+                os.write(port, bytes([mask | (RESYNC if sent is None else 0)]))
+                sent = mask
+    finally:
+        termios.tcsetattr(stdin, termios.TCSADRAIN, saved)
+        if recorder is not None:
+            recorder.close()
+        out.write('\x1b[?25h\x1b[?1049l')
+        out.flush()
+        os.close(port)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
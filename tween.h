@@ -0,0 +1,157 @@
+#ifndef TWEEN
+#define TWEEN
+
+#include "gameengine.h"
+
+enum Easing {
+  EASE_LINEAR,
+  EASE_IN_QUAD,
+  EASE_OUT_QUAD,
+  EASE_IN_OUT_CUBIC,
+  EASE_COUNT
+};
+
+// Easing curves sampled at 33 points over t = 0..1, scaled to 0..255
+const byte EASING_SAMPLES = 33;
+const byte easingTables[EASE_COUNT][EASING_SAMPLES] PROGMEM = {
+  // EASE_LINEAR
+  {0, 8, 16, 24, 32, 40, 48, 56, 64, 72, 80, 88, 96, 104, 112, 120, 128, 135, 143, 151, 159, 167, 175, 183, 191, 199, 207, 215, 223, 231, 239, 247, 255},
+  // EASE_IN_QUAD
+  {0, 0, 1, 2, 4, 6, 9, 12, 16, 20, 25, 30, 36, 42, 49, 56, 64, 72, 81, 90, 100, 110, 121, 132, 143, 156, 168, 182, 195, 209, 224, 239, 255},
+  // EASE_OUT_QUAD
+  {0, 16, 31, 46, 60, 73, 87, 99, 112, 123, 134, 145, 155, 165, 174, 183, 191, 199, 206, 213, 219, 225, 230, 235, 239, 243, 246, 249, 251, 253, 254, 255, 255},
+  // EASE_IN_OUT_CUBIC
+  {0, 1, 3, 6, 11, 17, 24, 31, 40, 49, 59, 70, 81, 92, 104, 116, 128, 139, 151, 163, 174, 185, 196, 206, 215, 224, 231, 238, 244, 249, 252, 254, 255}
+};
+
+// Sample a curve at progress 0..255, interpolating between table points
+inline byte sampleEasing(byte inEasing, byte inProgress){
+  const byte* table = easingTables[inEasing];
+  byte index = inProgress >> 3;
+  byte frac = inProgress & 7;
+  byte a = pgm_read_byte(&table[index]);
+  byte b = pgm_read_byte(&table[index + 1]);
+  return a + (((int)(b - a) * frac) >> 3);
+}
+
+struct Tween {
+  int* target;        // nullptr when the slot is free
+  int from;
+  int delta;
+  uint16_t phase;     // Progress scaled to 0..65535
+  uint16_t step;      // Phase added per frame
+  uint16_t framesLeft;
+  byte easing;
+  void (*onComplete)(void*);
+  void* args;
+};
+
+// Fixed pool of tweens, all advanced in one pass per frame
+class TweenPool : public Updateable {
+  public:
+    static const byte MAX_TWEENS = 8;
+    Tween tweens[MAX_TWEENS];
+    byte numActive = 0;
+
+    TweenPool(){
+      for( byte i = 0; i < MAX_TWEENS; i++ ){
+        tweens[i].target = nullptr;
+      }
+    }
+
+    // Drive *inTarget to inTo over inFrames frames, replacing any tween already on that target.
+    // A zero length tween is applied immediately. Returns false when the pool is full.
+    bool start(int* inTarget, int inTo, uint16_t inFrames, byte inEasing = EASE_LINEAR, void (*inOnComplete)(void*) = nullptr, void* inArgs = nullptr){
+      stop(inTarget);
+      if( inFrames == 0 ){
+        *inTarget = inTo;
+        if( inOnComplete != nullptr ){
+          inOnComplete(inArgs);
+        }
+        return true;
+      }
+      for( byte i = 0; i < MAX_TWEENS; i++ ){
+        Tween& tween = tweens[i];
+        if( tween.target == nullptr ){
+          tween.target = inTarget;
+          tween.from = *inTarget;
+          tween.delta = inTo - *inTarget;
+          tween.phase = 0;
+          tween.step = 0xFFFF / inFrames;
+          tween.framesLeft = inFrames;
+          tween.easing = inEasing;
+          tween.onComplete = inOnComplete;
+          tween.args = inArgs;
+          numActive++;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Cancel the tween on a target, leaving its current value in place
+    void stop(int* inTarget){
+      for( byte i = 0; i < MAX_TWEENS; i++ ){
+        if( tweens[i].target == inTarget ){
+          tweens[i].target = nullptr;
+          numActive--;
+        }
+      }
+    }
+
+    bool isActive(int* inTarget) const {
+      for( byte i = 0; i < MAX_TWEENS; i++ ){
+        if( tweens[i].target == inTarget ){
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Sum of the values a tween from inFrom to inTo would write over its frames, matching update().
+    // For a speed ramp this is the distance covered before it ends.
+    static int32_t sumValues(int inFrom, int inTo, uint16_t inFrames, byte inEasing = EASE_LINEAR){
+      if( inFrames == 0 ){
+        return inTo;
+      }
+      int32_t total = inTo;
+      int delta = inTo - inFrom;
+      uint16_t phase = 0;
+      uint16_t step = 0xFFFF / inFrames;
+      for( uint16_t frame = 1; frame < inFrames; frame++ ){
+        phase += step;
+        int ease = sampleEasing(inEasing, phase >> 8);
+        total += inFrom + (int)(((int32_t)delta * (ease + (ease >> 7))) >> 8);
+      }
+      return total;
+    }
+
+    void update() override {
+      if( numActive == 0 ){
+        return;
+      }
+      for( byte i = 0; i < MAX_TWEENS; i++ ){
+        Tween& tween = tweens[i];
+        if( tween.target == nullptr ){
+          continue;
+        }
+        tween.framesLeft--;
+        if( tween.framesLeft == 0 ){
+          // Land exactly on the end value and free the slot before the callback can reuse it
+          *tween.target = tween.from + tween.delta;
+          tween.target = nullptr;
+          numActive--;
+          if( tween.onComplete != nullptr ){
+            tween.onComplete(tween.args);
+          }
+          continue;
+        }
+        tween.phase += tween.step;
+        int ease = sampleEasing(tween.easing, tween.phase >> 8);
+        // Map 0..255 onto 0..256 so the scale is a shift
+        *tween.target = tween.from + (int)(((int32_t)tween.delta * (ease + (ease >> 7))) >> 8);
+      }
+    }
+};
+
+#endif
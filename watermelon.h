@@ -1,6 +1,12 @@
 #ifndef WATERMELON
 #define WATERMELON
+
+#include "tween.h"
+#include "alias.h"
+#include "text.h"
+
 const int SCALE_FACTOR = 1000; // Represents 1.0 as 1000
+const int REEL_MAX_SYMBOLS = 8; // Symbols a reel has room for
 
 enum class ReelStates {
     STATE_MIN,
@@ -12,31 +18,32 @@ enum class ReelStates {
     STATE_MAX = REEL_NUDGING
 };
 
+// Reel transitions, anything not listed here is rejected by the StateMachine
+template <>
+struct StateTransitions<ReelStates> {
+    static constexpr uint16_t allowed(ReelStates from) {
+        return from == ReelStates::REEL_STOPPED  ? stateBit(ReelStates::REEL_STARTING) | stateBit(ReelStates::REEL_STOPPING) :
+               from == ReelStates::REEL_STARTING ? stateBit(ReelStates::REEL_SPINNING) :
+               from == ReelStates::REEL_SPINNING ? stateBit(ReelStates::REEL_STOPPING) :
+               from == ReelStates::REEL_STOPPING ? stateBit(ReelStates::REEL_NUDGING) :
+               from == ReelStates::REEL_NUDGING  ? stateBit(ReelStates::REEL_STOPPED) : 0;
+    }
+};
+
 class Reel : public Renderable, public Controllable, public Updateable {
 public:
+    static const byte NUM_CONTROLS = 4; // Added by takeControl
 
-    Reel(Arduboy2* inArduboy, ControllerList* inControllerList, const unsigned char** inSymbols, int* inSymbolIDs, int inNumSymbols, int inSymbolSize, int inVisibleSymbols, int inFrameRate, int inSpinUpRate, int inSpinDownRate, int inMinSpinFrames, int inMaxSpinFrames)
-        : Renderable(inArduboy), Controllable(inControllerList), numSymbols(inNumSymbols), visibleSymbols(inVisibleSymbols), stateMachine(inControllerList, ReelStates::REEL_STOPPED), spinUpRate(inSpinUpRate), spinDownRate(inSpinDownRate), minSpinDuration(inMinSpinFrames), maxSpinDuration(inMaxSpinFrames) {
+    Reel(Arduboy2Base* inArduboy, ControllerList* inControllerList, TweenPool* inTweens, const unsigned char** inSymbols, int* inSymbolIDs, int inNumSymbols, int inSymbolSize, int inVisibleSymbols, int inFrameRate, int inSpinUpRate, int inSpinDownRate, int inMinSpinFrames, int inMaxSpinFrames)
+        : Renderable(inArduboy), Controllable(inControllerList), tweens(inTweens), symbols(inSymbols), symbol(inArduboy, nullptr, inSymbolSize, 1, inFrameRate), symbolSize(inSymbolSize), numSymbols(min(inNumSymbols, REEL_MAX_SYMBOLS)), visibleSymbols(inVisibleSymbols), spinUpRate(inSpinUpRate), spinDownRate(inSpinDownRate), minSpinDuration(inMinSpinFrames), maxSpinDuration(inMaxSpinFrames), stateMachine(inControllerList, ReelStates::REEL_STOPPED, stateHandlers, this) {
         // Copy the symbol IDs into the reel
-        symbolIDs = new int[numSymbols];
         for (int i = 0; i < numSymbols; ++i) {
             symbolIDs[i] = inSymbolIDs[i];
         }
-
-        // Initialize the Animator objects for the symbols
-        symbols = new Animator*[numSymbols];
-        symbolSize = inSymbolSize;
-        for (int i = 0; i < numSymbols; ++i) {
-            symbols[i] = new Animator(inArduboy, &inSymbols[symbolIDs[i]], symbolSize, 1, inFrameRate);
-        }
     }
 
     ~Reel() {
-        for (int i = 0; i < numSymbols; ++i) {
-            delete symbols[i];
-        }
-        delete[] symbols;
-        delete[] symbolIDs;
+        tweens -> stop(&currentSpinSpeed);
     }
 
     //////////////////
@@ -46,11 +53,11 @@ public:
 
     void playButton(){
         if (stateMachine.getState() == ReelStates::REEL_STOPPED) {
-            stateMachine.setState(ReelStates::REEL_STARTING);
+            stateMachine.transition<ReelStates::REEL_STOPPED, ReelStates::REEL_STARTING>();
         }
         else if(stateMachine.getState() == ReelStates::REEL_SPINNING){
-            if( spinFrames >= minSpinDuration ){
-                stateMachine.setState(ReelStates::REEL_STOPPING);   
+            if( stateMachine.getFramesInState() >= minSpinDuration ){
+                stateMachine.transition<ReelStates::REEL_SPINNING, ReelStates::REEL_STOPPING>();
             }
             else{
                 pendingStop = true;
@@ -58,10 +65,12 @@ public:
         }
     }
 
+    // Only from a stopped reel. A nudge during spin-up would cut the ramp short under a stop
+    // already planned for full speed.
     void addNudge(int inNudges){
-        if( !isSpinning() ){
-            nudges += inNudges;   
-            stateMachine.setState(ReelStates::REEL_STOPPING);
+        if( isStopped() ){
+            nudges += inNudges;
+            stateMachine.transition<ReelStates::REEL_STOPPED, ReelStates::REEL_STOPPING>();
         }
     }
 
@@ -89,57 +98,93 @@ public:
     // ArduboyEngine //
     ///////////////////
 
-    void update() override {
+    void update() override final {
         stateMachine.update();
+    }
 
-        switch (stateMachine.getState()) {
-            case ReelStates::REEL_STOPPED:
-                pendingStop = false;
-                // Reel is fully stopped, no action needed
-                break;
+    /////////////////
+    // Reel States //
+    /////////////////
 
-            case ReelStates::REEL_STARTING:
-                handleReelUpdate();
-                handleReelSpinUp();
+    static void onStoppedEnter(void* data){
+        Reel* reel = static_cast<Reel*>(data);
+        reel -> pendingStop = false;
+    }
 
-                if(currentSpinSpeed >= spinSpeed) {
-                    currentSpinSpeed = spinSpeed;
-                    spinFrames = 0;
-                    stateMachine.setState(ReelStates::REEL_SPINNING);
-                }
+    static void onStartingEnter(void* data){
+        Reel* reel = static_cast<Reel*>(data);
+        reel -> pickTargetStop();
+        reel -> handleReelSpinUp();
+    }
 
-                break;
-			case ReelStates::REEL_SPINNING:
-                spinFrames += 1;
-                if( spinFrames >= maxSpinDuration ){
-                    stateMachine.setState(ReelStates::REEL_STOPPING);
-                }
-                else if( pendingStop && spinFrames >= minSpinDuration ){
-                    stateMachine.setState(ReelStates::REEL_STOPPING);
-                }
+    static void onStartingTick(void* data){
+        Reel* reel = static_cast<Reel*>(data);
+        reel -> handleReelUpdate();
 
-                handleReelUpdate();
+        if(reel -> currentSpinSpeed >= reel -> spinSpeed) {
+            reel -> stateMachine.transition<ReelStates::REEL_STARTING, ReelStates::REEL_SPINNING>();
+        }
+    }
 
-	            break;
+    static void onSpinningEnter(void* data){
+        Reel* reel = static_cast<Reel*>(data);
+        reel -> currentSpinSpeed = reel -> spinSpeed;
+    }
+
+    static void onSpinningTick(void* data){
+        Reel* reel = static_cast<Reel*>(data);
+        int spinFrames = reel -> stateMachine.getFramesInState();
+        if( spinFrames >= reel -> maxSpinDuration ){
+            reel -> stateMachine.transition<ReelStates::REEL_SPINNING, ReelStates::REEL_STOPPING>();
+        }
+        else if( reel -> pendingStop && spinFrames >= reel -> minSpinDuration ){
+            reel -> stateMachine.transition<ReelStates::REEL_SPINNING, ReelStates::REEL_STOPPING>();
+        }
 
-	        case ReelStates::REEL_STOPPING:
-                handleReelUpdate();
-                handleReelSpinDown();
-                break;
+        reel -> handleReelUpdate();
+    }
 
-            case ReelStates::REEL_NUDGING:
-                if( nudges != 0 ){
-                    handleNudge();
-                }
-                else{
-                    stateMachine.setState(ReelStates::REEL_STOPPED);
-                }
-			    break;
+    static void onStoppingEnter(void* data){
+        Reel* reel = static_cast<Reel*>(data);
+        if( reel -> targetPosition >= 0 && reel -> currentSpinSpeed > 0 ){
+            reel -> bPlanPending = true; // Planned on the first stopping tick, once this frame's move is done
+        }
+        else{
+            reel -> targetPosition = -1;
+            reel -> handleReelSpinDown();
         }
     }
 
+    static void onStoppingTick(void* data){
+        Reel* reel = static_cast<Reel*>(data);
+        if( reel -> bPlanPending ){
+            reel -> planTargetStop();
+            if( reel -> coastDistance == 0 ){
+                reel -> handleReelSpinDown(); // Already the ramp's distance away, it moves from next frame
+                return;
+            }
+        }
+        if( reel -> coastDistance > 0 ){
+            reel -> handleReelCoast();
+        }
+        else{
+            reel -> handleReelUpdate();
+        }
+        reel -> handleReelSnap();
+    }
+
+    static void onNudgingTick(void* data){
+        Reel* reel = static_cast<Reel*>(data);
+        if( reel -> nudges != 0 ){
+            reel -> handleNudge();
+        }
+        else{
+            reel -> stateMachine.transition<ReelStates::REEL_NUDGING, ReelStates::REEL_STOPPED>();
+        }
+    }
 
-    void render() override {
+
+    void renderTo(const RenderTarget& target) override final {
         int numSymbolsToRender = visibleSymbols;
         if (isSpinning()) {
             numSymbolsToRender += 2; // Render two extra symbols during spinning
@@ -151,12 +196,31 @@ public:
             int fractionalOffset = (subPosition * symbolSize) / SCALE_FACTOR; // Fractional offset
             int yOffset = baseYOffset - fractionalOffset - symbolSize; // Adjust for extra symbols at the top
 
-            symbols[symbolIndex]->setPosition(posX, posY + yOffset);
-            symbols[symbolIndex]->render();
+            if (symbolPack != nullptr) {
+                symbol.setSprite(symbolPack, symbolIDs[symbolIndex]);
+            }
+            else {
+                symbol.setSprite(&symbols[symbolIDs[symbolIndex]], 1);
+            }
+            symbol.setPosition(posX, posY + yOffset);
+            symbol.renderTo(target);
         }
 
-        renderDebugOutput();
+        renderDebugOutput(target);
+
+    }
 
+    // From the extra symbol above the window down to the one below it while spinning,
+    // widened to the debug text when it is on
+    void getPageSpan(int8_t& first, int8_t& last) const override final {
+        int top = posY - 2 * symbolSize;
+        int bottom = posY + (isSpinning() ? visibleSymbols + 1 : visibleSymbols) * symbolSize - 1;
+        if (debugOutput) {
+            top = min(top, posY - 12);
+            bottom = max(bottom, posY + 16 + 4 + 7);
+        }
+        first = max(top, 0) >> 3;
+        last = min(bottom, HEIGHT - 1) >> 3;
     }
 
     void takeControl() override {
@@ -184,16 +248,80 @@ public:
         }
     }
 
-    void handleReelSpinUp(){
-        if(currentSpinSpeed < spinSpeed) {
-            currentSpinSpeed = min(currentSpinSpeed + spinUpRate, spinSpeed);
+    // Frames for a linear ramp covering inDistance at inRate per frame
+    static uint16_t rampFrames(int inDistance, int inRate){
+        if( inRate <= 0 || inDistance <= 0 ){
+            return 0;
         }
+        return (inDistance + inRate - 1) / inRate;
+    }
+
+    void handleReelSpinUp(){
+        tweens -> start(&currentSpinSpeed, spinSpeed, rampFrames(spinSpeed - currentSpinSpeed, spinUpRate), spinUpEasing);
     }
 
     void handleReelSpinDown(){
-        if (currentSpinSpeed > 0) {
-            currentSpinSpeed = max(currentSpinSpeed - spinDownRate, 0);
-        } else {
+        tweens -> start(&currentSpinSpeed, 0, rampFrames(currentSpinSpeed, spinDownRate), spinDownEasing);
+    }
+
+    // Choose where a weighted reel will stop, before it starts moving
+    void pickTargetStop(){
+        targetPosition = stopTable != nullptr ? stopTable -> pick(*random) : -1;
+        coastDistance = 0;
+        bPlanPending = false;
+    }
+
+    // Distance left along the spin direction to targetPosition, in SCALE_FACTOR units
+    int32_t distanceToTarget() const {
+        int32_t revolution = (int32_t)numSymbols * SCALE_FACTOR;
+        int32_t here = (int32_t)currentPosition * SCALE_FACTOR + subPosition;
+        int32_t distance = ((int32_t)targetPosition * SCALE_FACTOR - here) * spinDirection;
+        while( distance < 0 ){
+            distance += revolution;
+        }
+        return distance;
+    }
+
+    // Keep spinning at full speed for exactly as far as lets the spin-down ramp end on the target
+    void planTargetStop(){
+        bPlanPending = false;
+        coastDistance = 0;
+        if( currentSpinSpeed <= 0 ){
+            return; // Nothing to plan with, the snap puts it on the target
+        }
+        int32_t rampDistance = TweenPool::sumValues(currentSpinSpeed, 0, rampFrames(currentSpinSpeed, spinDownRate), spinDownEasing);
+        int32_t distance = distanceToTarget();
+        while( distance < rampDistance ){
+            distance += (int32_t)numSymbols * SCALE_FACTOR;
+        }
+        coastDistance = distance - rampDistance;
+    }
+
+    void handleReelCoast(){
+        // The last coast frame only moves what is left, so the ramp starts on the planned spot
+        int speed = currentSpinSpeed;
+        if( coastDistance < speed ){
+            currentSpinSpeed = coastDistance;
+        }
+        handleReelUpdate();
+        coastDistance -= currentSpinSpeed;
+        currentSpinSpeed = speed;
+        if( coastDistance == 0 ){
+            handleReelSpinDown();
+        }
+    }
+
+    void handleReelSnap(){
+        if (currentSpinSpeed <= 0) {
+            if (targetPosition >= 0) {
+                // The ramp was planned to end here, drop any rounding left in subPosition
+                currentPosition = targetPosition;
+                subPosition = 0;
+                targetPosition = -1;
+                currentSpinSpeed = 0;
+                stateMachine.transition<ReelStates::REEL_STOPPING, ReelStates::REEL_NUDGING>();
+                return;
+            }
             // Snap to nearest symbol using midpoint (500) and spin direction
             if (subPosition * spinDirection >= (SCALE_FACTOR / 2)) {
                 // Move one full step in the spin direction
@@ -202,7 +330,7 @@ public:
             // Reset to clean position
             subPosition = 0;
             currentSpinSpeed = 0;
-            stateMachine.setState(ReelStates::REEL_NUDGING);
+            stateMachine.transition<ReelStates::REEL_STOPPING, ReelStates::REEL_NUDGING>();
         }
     }
 
@@ -227,6 +355,51 @@ public:
         }
     }
 
+    //////////////
+    // Snapshot //
+    //////////////
+
+    void save(BitWriter& writer){
+        writer.write(static_cast<byte>(stateMachine.getState()), 3);
+        writer.writeDelta(stateMachine.getFramesInState(), 0, 16);
+        writer.write(currentPosition, bitsFor(numSymbols - 1));
+        writer.writeDelta(subPosition, 0, 11);
+        writer.writeDelta(currentSpinSpeed, 0, 16);
+        writer.writeDelta(nudges, 0, 8);
+        writer.writeBool(pendingStop);
+        writer.writeDelta(targetPosition, -1, bitsFor(numSymbols - 1) + 1);
+        writer.writeBool(bPlanPending);
+        writer.writeDelta(coastDistance, 0, 16);
+    }
+
+    void restore(BitReader& reader){
+        ReelStates state = static_cast<ReelStates>(reader.read(3));
+        uint16_t framesInState = reader.readDelta(0, 16);
+        currentPosition = reader.read(bitsFor(numSymbols - 1)) % numSymbols;
+        subPosition = reader.readDelta(0, 11);
+        currentSpinSpeed = reader.readDelta(0, 16);
+        nudges = reader.readDelta(0, 8);
+        pendingStop = reader.readBool();
+        targetPosition = reader.readDelta(-1, bitsFor(numSymbols - 1) + 1);
+        bPlanPending = reader.readBool();
+        coastDistance = (uint16_t)reader.readDelta(0, 16);
+        if( targetPosition >= numSymbols ){
+            targetPosition = -1;
+        }
+        stateMachine.restoreState(state, framesInState);
+
+        // Ramps live in the tween pool, restart them from the restored speed
+        if( state == ReelStates::REEL_STARTING ){
+            handleReelSpinUp();
+        }
+        else if( state == ReelStates::REEL_STOPPING && targetPosition >= 0 && coastDistance == 0 ){
+            bPlanPending = true; // Mid ramp, so re-plan the stop from the restored speed
+        }
+        else if( state == ReelStates::REEL_STOPPING && targetPosition < 0 ){
+            handleReelSpinDown();
+        }
+    }
+
     /////////////
     // Getters //
     /////////////
@@ -237,18 +410,45 @@ public:
                stateMachine.getState() == ReelStates::REEL_NUDGING;
     }
 
+    bool isStopped() const {
+        return stateMachine.getState() == ReelStates::REEL_STOPPED;
+    }
+
+    int getPosX() const {
+        return posX;
+    }
+
+    int getPosY() const {
+        return posY;
+    }
+
+    int getSymbolSize() const {
+        return symbolSize;
+    }
+
     int getCurrentPosition() const {
         return currentPosition;
     }
 
+    // Symbol shown in visible row index (0 is the top row), matching what render() draws once stopped
     int getVisibleSymbolID(int index) const {
         if (index >= 0 && index < visibleSymbols) {
-            int symbolIndex = (currentPosition + index) % numSymbols;
+            int symbolIndex = currentPosition + index - 1;
+            if (symbolIndex < 0) {
+                symbolIndex += numSymbols;
+            }
+            while (symbolIndex >= numSymbols) {
+                symbolIndex -= numSymbols;
+            }
             return symbolIDs[symbolIndex];
         }
         return -1; // Invalid index
     }
 
+    int getVisibleSymbols() const {
+        return visibleSymbols;
+    }
+
 
     ReelStates getState() const {
         return stateMachine.getState();
@@ -274,10 +474,28 @@ public:
         spinDownRate = downRate;
     }
 
+    void setSpinEasing(byte upEasing, byte downEasing) {
+        spinUpEasing = upEasing;
+        spinDownEasing = downEasing;
+    }
+
     void setspinSpeed(int speed) {
         spinSpeed = speed;
     }
 
+    // Draw the symbols from an asset pack, symbol IDs are then sprite indices in the pack.
+    // Lets the reel be built with nullptr symbols.
+    void setSymbolPack(const AssetPack* inPack) {
+        symbolPack = inPack;
+    }
+
+    // Pre-select each spin's stop from a weighted table over reel positions, nullptr for free-running stops.
+    // The table and Random must outlive the reel.
+    void setStopTable(const AliasTable* inTable, Random* inRandom){
+        stopTable = inTable;
+        random = inRandom;
+    }
+
     void setDebugOutput(bool b){
         debugOutput = b;
     }
@@ -285,45 +503,45 @@ public:
     /////////////////
     // Other Utils //
     /////////////////
-    void renderDebugOutput(){
+    void renderDebugOutput(const RenderTarget& target){
         if(debugOutput){
             // Debugging information (optional)
-            arduboy->setCursor(posX + symbolSize + 2, posY - 16 + 4);
-            arduboy->print(currentPosition);
+            int textX = posX + symbolSize + 2;
+            drawText(target, textX, posY - 16 + 4, debugPosition.format(currentPosition));
 
-            arduboy->setCursor(posX + symbolSize + 2, posY - 8 + 4);
+            const char* stateText = "";
             switch (stateMachine.getState()) {
                 case ReelStates::REEL_STOPPED:
-                    arduboy->print("STPD");
+                    stateText = "STPD";
                     break;
                 case ReelStates::REEL_STARTING:
-                    arduboy->print("STR");
+                    stateText = "STR";
                     break;
                 case ReelStates::REEL_SPINNING:
-                    arduboy->print("SPN");
+                    stateText = "SPN";
                     break;
                 case ReelStates::REEL_STOPPING:
-                    arduboy->print("STPN");
+                    stateText = "STPN";
                     break;
                 case ReelStates::REEL_NUDGING:
-                    arduboy->print("NDGE");
+                    stateText = "NDGE";
                     break;
             }
+            drawText(target, textX, posY - 8 + 4, stateText);
 
-            arduboy->setCursor(posX + symbolSize + 2, posY + 4);
-            arduboy->print(pendingStop ? "t" : "f");
-            arduboy->setCursor(posX + symbolSize + 2, posY + 8 + 4);
-            arduboy->print(currentSpinSpeed);
-            arduboy->setCursor(posX + symbolSize + 2, posY + 16 + 4);
-            arduboy->print(nudges);
-            // arduboy->setCursor(posX + symbolSize + 2, posY + 24 + 4);
-            // arduboy->print(minSpinDuration);
+            drawText(target, textX, posY + 4, pendingStop ? "t" : "f");
+            drawText(target, textX, posY + 8 + 4, debugSpinSpeed.format(currentSpinSpeed));
+            drawText(target, textX, posY + 16 + 4, debugNudges.format(nudges));
+            // drawText(target, textX, posY + 24 + 4, debugMinSpin.format(minSpinDuration));
         }
     }
 
 private:
-    Animator** symbols;       // Array of Animator objects for the symbols
-    int* symbolIDs;           // Array of symbol IDs (e.g., 0, 1, 2, 3, etc.)
+    TweenPool* tweens;        // Drives currentSpinSpeed during spin up/down
+    const unsigned char** symbols;       // Sprites indexed by symbol ID, unused when drawing from a pack
+    const AssetPack* symbolPack = nullptr;
+    Animator symbol;                     // Pointed at each symbol in turn as it is drawn, they are all single frames
+    byte symbolIDs[REEL_MAX_SYMBOLS];    // Symbol IDs (e.g., 0, 1, 2, 3, etc.)
     int symbolSize;
     int numSymbols;           // Total number of symbols on the reel
     int visibleSymbols;       // Number of symbols visible at a time
@@ -340,19 +558,204 @@ private:
     int currentSpinSpeed = 0;
     int spinUpRate = 50;
     int spinDownRate = 10;
+    byte spinUpEasing = EASE_LINEAR;
+    byte spinDownEasing = EASE_LINEAR;
     int nudgeSpeed = 30;
 
-    uint32_t spinStartFrame = 0;    // Track when spinning started
     bool pendingStop = false;       // Track if stop was requested early
     int minSpinDuration = 60;  // Minimum spin duration (frames)
     int maxSpinDuration = 300; // Maximum spin duration (frames)
     bool debugOutput = false;
+    CachedNumber debugPosition;
+    CachedNumber debugSpinSpeed;
+    CachedNumber debugNudges;
     int debugID = 0;
-    int spinFrames = 0;
 
     int nudges = 0;
 
+    const AliasTable* stopTable = nullptr;
+    Random* random = nullptr;
+    int targetPosition = -1;    // Planned stop, -1 when the reel stops wherever it slows down
+    uint16_t coastDistance = 0; // Full speed distance left before the planned spin-down starts
+    bool bPlanPending = false;
+
     StateMachine<ReelStates> stateMachine; // State machine for managing reel states
+
+    static const StateHandlers stateHandlers[];
+};
+
+// Indexed by ReelStates, kept in flash
+const StateHandlers Reel::stateHandlers[] PROGMEM = {
+    { &Reel::onStoppedEnter,  nullptr,               nullptr }, // REEL_STOPPED
+    { &Reel::onStartingEnter, &Reel::onStartingTick, nullptr }, // REEL_STARTING
+    { &Reel::onSpinningEnter, &Reel::onSpinningTick, nullptr }, // REEL_SPINNING
+    { &Reel::onStoppingEnter, &Reel::onStoppingTick, nullptr }, // REEL_STOPPING
+    { nullptr,                &Reel::onNudgingTick,  nullptr }  // REEL_NUDGING
+};
+
+// Owns up to NUM_REELS reels side by side in one block and drives them as one unit: a single
+// set of controls for the whole bank, one update and one render loop over concrete Reels,
+// and manual stops that land one reel at a time, stopStagger frames apart.
+template <byte NUM_REELS>
+class ReelBank : public Renderable, public Controllable, public Updateable {
+public:
+    static const byte NUM_CONTROLS = 4; // However many reels there are
+
+    ReelBank(Arduboy2Base* inArduboy, ControllerList* inControllerList)
+        : Renderable(inArduboy), Controllable(inControllerList) {}
+
+    ~ReelBank() {
+        for (byte i = 0; i < numReels; ++i) {
+            getReel(i).~Reel();
+        }
+    }
+
+    // Construct the next reel in place, taking Reel's constructor arguments after the ControllerList.
+    // Returns nullptr when the bank is full.
+    template <typename... Args>
+    Reel* addReel(Args... args) {
+        if (numReels >= NUM_REELS) {
+            return nullptr;
+        }
+        return new (storage[numReels++]) Reel(arduboy, controllerList, args...);
+    }
+
+    Reel& getReel(byte index) {
+        return *reinterpret_cast<Reel*>(storage[index]);
+    }
+
+    const Reel& getReel(byte index) const {
+        return *reinterpret_cast<const Reel*>(storage[index]);
+    }
+
+    byte getNumReels() const {
+        return numReels;
+    }
+
+    bool isStopped() const {
+        for (byte i = 0; i < numReels; ++i) {
+            if (!getReel(i).isStopped()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void setStopStagger(int frames) {
+        stopStagger = frames;
+    }
+
+    //////////////
+    // CONTROLS //
+    //////////////
+
+    // Start every reel when all are stopped, otherwise begin stopping them left to right
+    void playButton() {
+        if (isStopped()) {
+            bStopping = false;
+            for (byte i = 0; i < numReels; ++i) {
+                getReel(i).playButton();
+            }
+        }
+        else if (!bStopping) {
+            bStopping = true;
+            nextStop = 0;
+            stopTimer = 0;
+        }
+    }
+
+    void addNudge(int inNudges) {
+        for (byte i = 0; i < numReels; ++i) {
+            getReel(i).addNudge(inNudges);
+        }
+    }
+
+    static void PLAY_PRESSED(void* data) {
+        static_cast<ReelBank*>(data) -> playButton();
+    }
+    static void NUDGE_UP(void* data) {
+        static_cast<ReelBank*>(data) -> addNudge(1);
+    }
+    static void NUDGE_DOWN(void* data) {
+        static_cast<ReelBank*>(data) -> addNudge(-1);
+    }
+
+    void takeControl() override {
+        addControl(BUTTON_JUST_PRESSED, A_BUTTON, &ReelBank::PLAY_PRESSED, this);
+        addControl(BUTTON_JUST_PRESSED, B_BUTTON, &ReelBank::PLAY_PRESSED, this);
+        addControl(BUTTON_JUST_PRESSED, UP_BUTTON,   &ReelBank::NUDGE_UP, this);
+        addControl(BUTTON_JUST_PRESSED, DOWN_BUTTON, &ReelBank::NUDGE_DOWN, this);
+    }
+
+    ///////////////////
+    // ArduboyEngine //
+    ///////////////////
+
+    void update() override {
+        if (bStopping) {
+            updateStaggeredStop();
+        }
+        for (byte i = 0; i < numReels; ++i) {
+            getReel(i).update(); // Stopped reels too, so REEL_STOPPED time shows in the state profile
+        }
+    }
+
+    void renderTo(const RenderTarget& target) override {
+        for (byte i = 0; i < numReels; ++i) {
+            Reel& reel = getReel(i);
+            if (touchesTarget(reel, target)) {
+                reel.renderTo(target);
+            }
+        }
+    }
+
+    //////////////
+    // Snapshot //
+    //////////////
+
+    void save(BitWriter& writer) {
+        for (byte i = 0; i < numReels; ++i) {
+            getReel(i).save(writer);
+        }
+        writer.writeBool(bStopping);
+        writer.write(nextStop, bitsFor(NUM_REELS));
+        writer.writeDelta(stopTimer, 0, 16);
+    }
+
+    void restore(BitReader& reader) {
+        for (byte i = 0; i < numReels; ++i) {
+            getReel(i).restore(reader);
+        }
+        bStopping = reader.readBool();
+        nextStop = reader.read(bitsFor(NUM_REELS));
+        stopTimer = reader.readDelta(0, 16);
+    }
+
+private:
+    alignas(Reel) byte storage[NUM_REELS][sizeof(Reel)];
+    byte numReels = 0;
+
+    int stopStagger = 20;   // Frames between manual reel stops
+    bool bStopping = false;
+    byte nextStop = 0;      // Next reel to ask to stop
+    int stopTimer = 0;      // Frames since the stop was requested
+
+    void updateStaggeredStop() {
+        while (nextStop < numReels && stopTimer >= nextStop * stopStagger) {
+            Reel& reel = getReel(nextStop);
+            if (reel.getState() == ReelStates::REEL_STARTING) {
+                break; // Still spinning up, ask again next frame
+            }
+            if (reel.getState() == ReelStates::REEL_SPINNING) {
+                reel.playButton(); // Waits out minSpinDuration if needed
+            }
+            nextStop++;
+        }
+        if (nextStop >= numReels) {
+            bStopping = false;
+        }
+        stopTimer++;
+    }
 };
 
 
@@ -0,0 +1,34 @@
+// Generated by tools/packassets.py, do not edit. Rebuild with:
+//   tools/packassets.py --compress watermelon watermelonpack.h assets/tile000.pbm assets/tile001.pbm assets/tile002.pbm assets/tile003.pbm assets/tile008.pbm assets/tile009.pbm assets/tile010.pbm assets/tile011.pbm
+#ifndef WATERMELON_PACK
+#define WATERMELON_PACK
+
+enum WatermelonSprite {
+  WATERMELON_TILE000,
+  WATERMELON_TILE001,
+  WATERMELON_TILE002,
+  WATERMELON_TILE003,
+  WATERMELON_TILE008,
+  WATERMELON_TILE009,
+  WATERMELON_TILE010,
+  WATERMELON_TILE011,
+  WATERMELON_COUNT
+};
+
+const byte watermelonPack[] PROGMEM = {
+  0x41, 0x50, 0x02, 0x08, 0x10, 0x10, 0x01, 0x00, 0x34, 0x00, 0x10, 0x10, 0x01, 0x81, 0x54, 0x00,
+  0x10, 0x10, 0x01, 0x81, 0x5f, 0x00, 0x10, 0x10, 0x01, 0x81, 0x70, 0x00, 0x10, 0x10, 0x01, 0x00,
+  0x83, 0x00, 0x10, 0x10, 0x01, 0x85, 0xa3, 0x00, 0x10, 0x10, 0x01, 0x85, 0xb4, 0x00, 0x10, 0x10,
+  0x01, 0x85, 0xc0, 0x00, 0xe0, 0x18, 0xe4, 0xfa, 0xfe, 0x1d, 0x0f, 0x67, 0x67, 0x0f, 0x1d, 0xfe,
+  0xfa, 0xe4, 0x18, 0xe0, 0x07, 0x18, 0x21, 0x47, 0x4f, 0x8c, 0x9c, 0x9f, 0x9f, 0x9c, 0x8c, 0x4f,
+  0x47, 0x21, 0x18, 0x07, 0x56, 0x00, 0xc4, 0x05, 0xe5, 0x47, 0x1f, 0x1f, 0x47, 0xe5, 0xd4, 0x61,
+  0x00, 0xc4, 0x05, 0x05, 0x07, 0xb7, 0xb7, 0x07, 0x4d, 0xcb, 0x03, 0x9d, 0x9d, 0x9c, 0x8e, 0xc4,
+  0x72, 0x00, 0xc4, 0x05, 0xe5, 0x87, 0x1f, 0x1f, 0x87, 0xe5, 0xc9, 0x05, 0x8f, 0x9f, 0x9c, 0x9c,
+  0x9f, 0x8f, 0xc4, 0xe0, 0x10, 0x10, 0x10, 0x1e, 0x01, 0x3d, 0x7d, 0x7d, 0x3d, 0x01, 0x1e, 0x10,
+  0x10, 0x10, 0xe0, 0x07, 0x08, 0x09, 0x09, 0x79, 0x81, 0x90, 0x90, 0x90, 0x90, 0x81, 0x79, 0x09,
+  0x09, 0x08, 0x07, 0xa5, 0x00, 0xc5, 0x03, 0x01, 0x81, 0x81, 0x01, 0xca, 0x05, 0x80, 0x9e, 0x9f,
+  0x9f, 0x9e, 0x80, 0xc4, 0xb6, 0x00, 0xc1, 0x04, 0xd0, 0xd0, 0xde, 0xc1, 0x81, 0x82, 0x01, 0xd4,
+  0xc2, 0x00, 0xc5, 0x81, 0x01, 0x04, 0x81, 0xc1, 0xde, 0xd0, 0xd0, 0xd1,
+};
+
+#endif